@@ -470,16 +470,16 @@ def attach_probes(
 
     runner = "./build_release/build/bin/ucsb_bench"
     bpf.attach_uprobe(
-        name=runner, sym_re=".*ucsb.*timer_t.*start.*", fn_name="bench_enter"
+        name=runner, sym_re=".*ucsb.*timer_t.*probe_start.*", fn_name="bench_enter"
     )
     bpf.attach_uprobe(
-        name=runner, sym_re=".*ucsb.*timer_t.*pause.*", fn_name="bench_exit"
+        name=runner, sym_re=".*ucsb.*timer_t.*probe_pause.*", fn_name="bench_exit"
     )
     bpf.attach_uprobe(
-        name=runner, sym_re=".*ucsb.*timer_t.*resume.*", fn_name="bench_enter"
+        name=runner, sym_re=".*ucsb.*timer_t.*probe_resume.*", fn_name="bench_enter"
     )
     bpf.attach_uprobe(
-        name=runner, sym_re=".*ucsb.*timer_t.*stop.*", fn_name="bench_exit"
+        name=runner, sym_re=".*ucsb.*timer_t.*probe_stop.*", fn_name="bench_exit"
     )
 
     return bpf, pid, process
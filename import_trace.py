@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+
+"""
+Converts an access log into a trace, which `ucsb_bench` replays instead of a synthetic workload.
+Point the `trace_path` of a workload to the output, add `"open_loop": true` to issue every
+operation at its logged time and `"replay_speedup"` to compress or stretch the time.
+
+Supported logs:
+ * CSV with `timestamp,operation,key,value_size[,length]` rows, an optional header line.
+   `length` is the number of entries of range selects and scans.
+ * Binary, packed little-endian records of `uint64 timestamp_ns, uint8 operation, uint64 key, uint32 value_size`.
+   Operations are numbered as `operation_kind_t` in `src/core/operation.hpp`.
+
+The trace layout is defined in `src/core/trace.hpp`.
+"""
+
+import argparse
+import csv
+import os
+import pathlib
+import struct
+import sys
+from typing import Dict, List, Tuple
+
+operation_codes = {
+    "upsert": 0,
+    "insert": 0,
+    "set": 0,
+    "put": 0,
+    "update": 1,
+    "remove": 2,
+    "delete": 2,
+    "del": 2,
+    "read": 3,
+    "get": 3,
+    "read_modify_write": 4,
+    "rmw": 4,
+    "range_select": 8,
+    "range": 8,
+    "scan": 9,
+}
+
+timestamp_units = {
+    "s": 1_000_000_000,
+    "ms": 1_000_000,
+    "us": 1_000,
+    "ns": 1,
+}
+
+trace_magic = b"UCSBTRC\0"
+trace_version = 1
+trace_header = struct.Struct("<8sII")
+trace_thread = struct.Struct("<QQQII")
+trace_record = struct.Struct("<QQIIII")
+binary_log_record = struct.Struct("<QBQI")
+
+# (timestamp_ns, operation, raw key, value size, length)
+log_entry_t = Tuple[int, int, str, int, int]
+
+
+def read_csv_log(path: str, unit: str) -> List[log_entry_t]:
+    entries = []
+    with open(path, newline="") as file:
+        for row in csv.reader(file):
+            if not row or row[0].startswith("#"):
+                continue
+            try:
+                timestamp = int(float(row[0]) * timestamp_units[unit])
+            except ValueError:
+                # Note: Only the header line may be non-numeric
+                if entries:
+                    sys.exit(f"Invalid timestamp: {row[0]}")
+                continue
+            operation = operation_codes.get(row[1].strip().lower())
+            if operation is None:
+                sys.exit(f"Unknown operation: {row[1]}")
+            value_size = int(row[3]) if len(row) > 3 and row[3] else 0
+            length = int(row[4]) if len(row) > 4 and row[4] else 1
+            entries.append((timestamp, operation, row[2].strip(), value_size, length))
+    return entries
+
+
+def read_binary_log(path: str) -> List[log_entry_t]:
+    entries = []
+    with open(path, "rb") as file:
+        data = file.read()
+    if len(data) % binary_log_record.size:
+        sys.exit(f"Binary log size isn't a multiple of {binary_log_record.size} bytes")
+    for timestamp, operation, key, value_size in binary_log_record.iter_unpack(data):
+        if operation not in operation_codes.values():
+            sys.exit(f"Unsupported operation code: {operation}")
+        entries.append((timestamp, operation, str(key), value_size, 1))
+    return entries
+
+
+def fnv1a_64(data: bytes) -> int:
+    digest = 0xCBF29CE484222325
+    for byte in data:
+        digest = ((digest ^ byte) * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return digest
+
+
+def remap_keys(entries: List[log_entry_t], key_map: str, start_key: int, records_count: int) -> Tuple[List[int], int]:
+    """
+    Maps the logged keys into the `key_t` space of the benchmark.
+    `dense` numbers the distinct keys from `start_key` in the order of their first access,
+    so the DB can be loaded with exactly them, `hash` spreads them over `records_count` keys,
+    `identity` keeps numeric keys as they are.
+    """
+    keys = []
+    if key_map == "dense":
+        ids: Dict[str, int] = {}
+        for entry in entries:
+            keys.append(start_key + ids.setdefault(entry[2], len(ids)))
+        return keys, len(ids)
+    if key_map == "hash":
+        for entry in entries:
+            keys.append(start_key + fnv1a_64(entry[2].encode()) % records_count)
+        return keys, len(set(keys))
+    for entry in entries:
+        try:
+            key = int(entry[2])
+        except ValueError:
+            key = -1
+        if not 0 <= key < 2**64:
+            sys.exit(f"Key isn't a 64-bit unsigned integer: {entry[2]}")
+        keys.append(key)
+    return keys, len(set(keys))
+
+
+def write_trace(path: str, threads: List[List[Tuple[int, int, int, int, int]]]) -> None:
+    pathlib.Path(path).parent.mkdir(parents=True, exist_ok=True)
+    offset = trace_header.size + trace_thread.size * len(threads)
+    table = []
+    for records in threads:
+        max_length = max((r[4] for r in records if r[1] != operation_codes["scan"]), default=0)
+        max_value_length = max((r[3] for r in records), default=0)
+        table.append(trace_thread.pack(offset, len(records), len(records), max_length, max_value_length))
+        offset += trace_record.size * len(records)
+
+    with open(path, "wb") as file:
+        file.write(trace_header.pack(trace_magic, trace_version, len(threads)))
+        for entry in table:
+            file.write(entry)
+        for records in threads:
+            for timestamp, operation, key, value_size, length in records:
+                file.write(trace_record.pack(key, timestamp, value_size, length, operation, 0))
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Import an access log as a UCSB trace")
+    parser.add_argument("log_path", help="CSV or binary access log")
+    parser.add_argument("trace_path", help="Output trace file")
+    parser.add_argument(
+        "-f",
+        "--format",
+        help="Log format",
+        choices=["csv", "binary"],
+        default="csv",
+    )
+    parser.add_argument(
+        "-u",
+        "--timestamp-unit",
+        help="Unit of the CSV timestamps",
+        choices=list(timestamp_units.keys()),
+        default="s",
+    )
+    parser.add_argument(
+        "-th",
+        "--threads",
+        help="Threads count of the replay, every key is always replayed by the same thread",
+        type=int,
+        default=1,
+    )
+    parser.add_argument(
+        "-km",
+        "--key-map",
+        help="How the logged keys are mapped into the benchmark key space",
+        choices=["dense", "hash", "identity"],
+        default="dense",
+    )
+    parser.add_argument("-sk", "--start-key", help="First key of the mapped key space", type=int, default=0)
+    parser.add_argument(
+        "-rc",
+        "--records-count",
+        help="Size of the key space for the hash mapping",
+        type=int,
+        default=1_000_000,
+    )
+    return parser.parse_args()
+
+
+def main() -> None:
+    args = parse_args()
+    if args.threads < 1:
+        sys.exit("Zero threads count specified")
+    if not os.path.exists(args.log_path):
+        sys.exit(f"Log not found: {args.log_path}")
+
+    if args.format == "csv":
+        entries = read_csv_log(args.log_path, args.timestamp_unit)
+    else:
+        entries = read_binary_log(args.log_path)
+    if not entries:
+        sys.exit("Log is empty")
+
+    # Timestamps become relative to the first access, merged logs may be out of order
+    entries.sort(key=lambda entry: entry[0])
+    first_timestamp = entries[0][0]
+    keys, distinct_keys_count = remap_keys(entries, args.key_map, args.start_key, args.records_count)
+
+    threads = [[] for _ in range(args.threads)]
+    for entry, key in zip(entries, keys):
+        timestamp, operation, _, value_size, length = entry
+        threads[key % args.threads].append((timestamp - first_timestamp, operation, key, value_size, length))
+    for idx, records in enumerate(threads):
+        if not records:
+            sys.exit(f"No operations for thread {idx}, use less threads")
+
+    write_trace(args.trace_path, threads)
+
+    duration = (entries[-1][0] - first_timestamp) / 1e9
+    print(f"Imported {len(entries)} operations over {duration:.3f}s into {args.trace_path}")
+    print(f"Distinct keys: {distinct_keys_count}, operations per thread: {[len(records) for records in threads]}")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 import argparse
+import json
 import os
 import pathlib
 import shutil
@@ -42,6 +43,9 @@ workload_names = [
 ]
 
 threads_count = 1
+threads_sweep = False
+cpu_list = ""
+numa_policy = "none"
 transactional = False
 
 drop_caches = False
@@ -82,6 +86,16 @@ def get_db_storage_dir_paths(
     return db_storage_dir_paths
 
 
+def get_results_root_dir_path(drop_caches: bool, transactional: bool) -> str:
+    if drop_caches:
+        if transactional:
+            return "./bench/results/without_caches/transactional/"
+        return "./bench/results/without_caches/"
+    if transactional:
+        return "./bench/results/transactional/"
+    return "./bench/results/"
+
+
 def get_results_file_path(
         db_name: str,
         size: str,
@@ -90,18 +104,7 @@ def get_results_file_path(
         storage_disk_paths: List[str],
         threads_count: int,
 ) -> str:
-    root_dir_path = ""
-    if drop_caches:
-        if transactional:
-            root_dir_path = "./bench/results/without_caches/transactional/"
-        else:
-            root_dir_path = "./bench/results/without_caches/"
-    else:
-        if transactional:
-            root_dir_path = "./bench/results/transactional/"
-        else:
-            root_dir_path = "./bench/results/"
-
+    root_dir_path = get_results_root_dir_path(drop_caches, transactional)
     disks_count = max(len(storage_disk_paths), 1)
     return os.path.join(
         f"{root_dir_path}cores_{threads_count}",
@@ -111,6 +114,123 @@ def get_results_file_path(
     )
 
 
+def get_scaling_file_path(
+        db_name: str,
+        size: str,
+        drop_caches: bool,
+        transactional: bool,
+        storage_disk_paths: List[str],
+) -> str:
+    root_dir_path = get_results_root_dir_path(drop_caches, transactional)
+    disks_count = max(len(storage_disk_paths), 1)
+    return os.path.join(
+        f"{root_dir_path}scaling",
+        f"disks_{disks_count}",
+        db_name,
+        f"{size}.json",
+    )
+
+
+def get_sweep_threads_counts(max_threads_count: int) -> List[int]:
+    """
+    Powers of two up to the given threads count, which is always the last step.
+    """
+    threads_counts = []
+    step_threads_count = 1
+    while step_threads_count < max_threads_count:
+        threads_counts.append(step_threads_count)
+        step_threads_count *= 2
+    threads_counts.append(max_threads_count)
+    return threads_counts
+
+
+def cleanup_db(db_name: str, size: str, main_dir_path: str, storage_disk_paths: List[str]) -> None:
+    # Remove DB main directory
+    db_main_dir_path = get_db_main_dir_path(db_name, size, main_dir_path)
+    if pathlib.Path(db_main_dir_path).exists():
+        shutil.rmtree(db_main_dir_path)
+
+    # Remove DB storage directories
+    db_storage_dir_paths = get_db_storage_dir_paths(db_name, size, storage_disk_paths)
+    for db_storage_dir_path in db_storage_dir_paths:
+        if pathlib.Path(db_storage_dir_path).exists():
+            shutil.rmtree(db_storage_dir_path)
+
+
+def get_queue_depths(size: str) -> dict:
+    """
+    Maps the names of the workloads, including the ones of their phases, to their `queue_depth`.
+    Phases inherit it from their workload, unless they override it.
+    """
+    with open(get_workloads_file_path(size)) as stream:
+        workloads = json.load(stream)
+    queue_depths = {}
+    for workload in workloads:
+        queue_depth = max(workload.get("queue_depth", 1), 1)
+        queue_depths[workload["name"]] = queue_depth
+        for idx, phase in enumerate(workload.get("phases", [])):
+            phase_name = f'{workload["name"]}:{phase.get("name", str(idx + 1))}'
+            queue_depths[phase_name] = max(phase.get("queue_depth", queue_depth), 1)
+    return queue_depths
+
+
+def report_scaling(
+        db_name: str,
+        size: str,
+        threads_counts: List[int],
+        drop_caches: bool,
+        transactional: bool,
+        storage_disk_paths: List[str],
+) -> None:
+    """
+    Collects the results of a threads sweep into a throughput and latency vs threads table.
+    Latency isn't measured, but derived per entry from the throughput of the closed-loop clients:
+    every thread keeps `queue_depth` operations in flight, and batch operations touch many entries.
+    Efficiency is the speedup over a single thread divided by threads.
+    """
+    queue_depths = get_queue_depths(size)
+    scaling = {}
+    for step_threads_count in threads_counts:
+        results_file_path = get_results_file_path(
+            db_name, size, drop_caches, transactional, storage_disk_paths, step_threads_count
+        )
+        if not pathlib.Path(results_file_path).exists():
+            continue
+        with open(results_file_path) as stream:
+            results = json.load(stream)
+        for benchmark in results["benchmarks"]:
+            workload_name = benchmark["name"].split("/")[0]
+            throughput = benchmark.get("operations/s", 0.0)
+            concurrency = step_threads_count * queue_depths.get(workload_name, 1)
+            latency = concurrency / throughput * 1e6 if throughput else 0.0
+            scaling.setdefault(workload_name, []).append(
+                {"threads": step_threads_count, "operations/s": throughput, "entry_latency,us": latency}
+            )
+
+    for steps in scaling.values():
+        base = steps[0]
+        for step in steps:
+            speedup = step["operations/s"] / base["operations/s"] if base["operations/s"] else 0.0
+            step["speedup"] = speedup
+            step["efficiency"] = speedup * base["threads"] / step["threads"]
+
+    scaling_file_path = get_scaling_file_path(db_name, size, drop_caches, transactional, storage_disk_paths)
+    pathlib.Path(scaling_file_path).parent.mkdir(parents=True, exist_ok=True)
+    with open(scaling_file_path, "w") as stream:
+        json.dump(scaling, stream, indent=2)
+
+    print(termcolor.colored(f"Threads scaling: {db_name} ({size})", "green"))
+    for workload_name, steps in scaling.items():
+        print(f"  {workload_name}")
+        print(f"  {'Threads':>8} | {'Throughput':>12} | {'Entry latency,us':>16} | {'Speedup':>7} | {'Efficiency':>10}")
+        for step in steps:
+            print(
+                f"  {step['threads']:>8} | {step['operations/s']:>10.0f}/s | {step['entry_latency,us']:>16.2f} | "
+                f"{step['speedup']:>7.2f} | {step['efficiency'] * 100:>9.1f}%"
+            )
+    print(f"  Saved to {scaling_file_path}")
+
+
 def drop_system_caches():
     print(end="\x1b[1K\r")
     print(" [✱] Dropping system caches...", end="\r")
@@ -136,6 +256,8 @@ def run(
         drop_caches: bool,
         run_in_docker_container: bool,
         threads_count: int,
+        cpu_list: str,
+        numa_policy: str,
         run_index: int,
         runs_count: int,
         with_ebpf: bool,
@@ -152,6 +274,7 @@ def run(
 
     transactional_flag = "-t" if transactional else ""
     lazy_flag = "-l" if with_ebpf else ""
+    placement_flags = f'-cpu "{cpu_list}" -numa {numa_policy}' if cpu_list else f"-numa {numa_policy}"
     filter = ",".join(workload_names)
     db_storage_dir_paths = ",".join(db_storage_dir_paths)
 
@@ -165,7 +288,7 @@ def run(
 
     process_cmd = f'{runner} -db {db_name} {transactional_flag} {lazy_flag} -cfg "{db_config_file_path}" ' \
                   f'-wl "{workloads_file_path}" -md "{db_main_dir_path}" -sd "{db_storage_dir_paths}" ' \
-                  f'-res "{results_file_path}" -th {threads_count} -fl {filter} -ri {run_index} -rc {runs_count}'
+                  f'-res "{results_file_path}" -th {threads_count} {placement_flags} -fl {filter} -ri {run_index} -rc {runs_count}'
     process = pexpect.spawn(process_cmd)
 
     if with_ebpf and (db_name == "mongodb" or db_name == "redis"):
@@ -223,6 +346,9 @@ def parse_args():
     global main_dir_path
     global storage_disk_paths
     global threads_count
+    global threads_sweep
+    global cpu_list
+    global numa_policy
     global transactional
     global cleanup_previous
     global drop_caches
@@ -281,6 +407,31 @@ def parse_args():
         required=False,
         default=threads_count,
     )
+    parser.add_argument(
+        "-sw",
+        "--threads-sweep",
+        help="Runs with 1, 2, 4, ... up to the given threads count and reports the scaling. "
+             "Steps only start from a fresh DB with --cleanup-previous and `Init` as the first workload, "
+             "otherwise every step runs on the DB left by the previous one",
+        action=argparse.BooleanOptionalAction,
+        default=threads_sweep,
+    )
+    parser.add_argument(
+        "-cpu",
+        "--cpu-list",
+        help="CPUs to pin the benchmark threads to, like 0-3,8",
+        type=str,
+        required=False,
+        default=cpu_list,
+    )
+    parser.add_argument(
+        "-numa",
+        "--numa-policy",
+        help="Memory placement of the benchmark threads",
+        choices=["none", "local", "interleave"],
+        required=False,
+        default=numa_policy,
+    )
     parser.add_argument(
         "-tx",
         "--transactional",
@@ -341,6 +492,9 @@ def parse_args():
     main_dir_path = args.main_dir
     storage_disk_paths = args.storage_dirs
     threads_count = args.threads
+    threads_sweep = args.threads_sweep
+    cpu_list = args.cpu_list
+    numa_policy = args.numa_policy
     transactional = args.transactional
     cleanup_previous = args.cleanup_previous
     drop_caches = args.drop_caches
@@ -383,81 +537,85 @@ def main() -> None:
         print(" [✱] Cleanup...", end="\r")
         for size in sizes:
             for db_name in db_names:
-                # Remove DB main directory
+                cleanup_db(db_name, size, main_dir_path, storage_disk_paths)
+
+    # Run benchmarks
+    threads_counts = get_sweep_threads_counts(threads_count) if threads_sweep else [threads_count]
+    for size in sizes:
+        for db_name in db_names:
+            for step_idx, step_threads_count in enumerate(threads_counts):
+                # Every step of a sweep starts from a fresh DB, if it's initialized by the workloads
+                if step_idx and cleanup_previous and workload_names[0] == "Init":
+                    cleanup_db(db_name, size, main_dir_path, storage_disk_paths)
+
+                # Create DB main directory
                 db_main_dir_path = get_db_main_dir_path(db_name, size, main_dir_path)
-                if pathlib.Path(db_main_dir_path).exists():
-                    shutil.rmtree(db_main_dir_path)
+                pathlib.Path(db_main_dir_path).mkdir(parents=True, exist_ok=True)
 
-                # Remove DB storage directories
+                # Create DB storage directories
                 db_storage_dir_paths = get_db_storage_dir_paths(
                     db_name, size, storage_disk_paths
                 )
                 for db_storage_dir_path in db_storage_dir_paths:
-                    if pathlib.Path(db_storage_dir_path).exists():
-                        shutil.rmtree(db_storage_dir_path)
+                    pathlib.Path(db_storage_dir_path).mkdir(parents=True, exist_ok=True)
 
-    # Run benchmarks
-    for size in sizes:
-        for db_name in db_names:
-            # Create DB main directory
-            db_main_dir_path = get_db_main_dir_path(db_name, size, main_dir_path)
-            pathlib.Path(db_main_dir_path).mkdir(parents=True, exist_ok=True)
-
-            # Create DB storage directories
-            db_storage_dir_paths = get_db_storage_dir_paths(
-                db_name, size, storage_disk_paths
-            )
-            for db_storage_dir_path in db_storage_dir_paths:
-                pathlib.Path(db_storage_dir_path).mkdir(parents=True, exist_ok=True)
-
-            # Create results dir paths
-            results_file_path = get_results_file_path(
-                db_name,
-                size,
-                drop_caches,
-                transactional,
-                storage_disk_paths,
-                threads_count,
-            )
-            pathlib.Path(results_file_path).parent.mkdir(parents=True, exist_ok=True)
-
-            # Run benchmark
-            if drop_caches:
-                for i, workload_name in enumerate(workload_names):
-                    if not run_in_docker_container:
-                        drop_system_caches()
+                # Create results dir paths
+                results_file_path = get_results_file_path(
+                    db_name,
+                    size,
+                    drop_caches,
+                    transactional,
+                    storage_disk_paths,
+                    step_threads_count,
+                )
+                pathlib.Path(results_file_path).parent.mkdir(parents=True, exist_ok=True)
+
+                # Run benchmark
+                if drop_caches:
+                    for i, workload_name in enumerate(workload_names):
+                        if not run_in_docker_container:
+                            drop_system_caches()
+                        run(
+                            db_name,
+                            size,
+                            [workload_name],
+                            main_dir_path,
+                            storage_disk_paths,
+                            transactional,
+                            drop_caches,
+                            run_in_docker_container,
+                            step_threads_count,
+                            cpu_list,
+                            numa_policy,
+                            i,
+                            len(workload_names),
+                            with_ebpf,
+                            with_ebpf_memory,
+                            with_syscall_details,
+                        )
+                else:
                     run(
                         db_name,
                         size,
-                        [workload_name],
+                        workload_names,
                         main_dir_path,
                         storage_disk_paths,
                         transactional,
                         drop_caches,
                         run_in_docker_container,
-                        threads_count,
-                        i,
-                        len(workload_names),
+                        step_threads_count,
+                        cpu_list,
+                        numa_policy,
+                        0,
+                        1,
                         with_ebpf,
                         with_ebpf_memory,
                         with_syscall_details,
                     )
-            else:
-                run(
-                    db_name,
-                    size,
-                    workload_names,
-                    main_dir_path,
-                    storage_disk_paths,
-                    transactional,
-                    drop_caches,
-                    run_in_docker_container,
-                    threads_count,
-                    0,
-                    1,
-                    with_ebpf,
-                    with_ebpf_memory,
-                    with_syscall_details,
+
+            if threads_sweep:
+                report_scaling(
+                    db_name, size, threads_counts, drop_caches, transactional, storage_disk_paths
                 )
 
 
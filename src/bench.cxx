@@ -1,5 +1,9 @@
 #include <atomic>
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <thread>
+#include <optional>
 #include <string>
 #include <vector>
 #include <signal.h>
@@ -19,6 +23,7 @@
 #include "src/core/db.hpp"
 #include "src/core/workload.hpp"
 #include "src/core/worker.hpp"
+#include "src/core/async.hpp"
 #include "src/core/db_brand.hpp"
 #include "src/core/db_hint.hpp"
 #include "src/core/distribution.hpp"
@@ -27,6 +32,7 @@
 #include "src/core/printable.hpp"
 #include "src/core/reporter.hpp"
 #include "src/core/threads_fence.hpp"
+#include "src/core/trace.hpp"
 
 namespace bm = benchmark;
 using namespace ucsb;
@@ -47,6 +53,15 @@ void parse_and_validate_args(int argc, char* argv[], settings_t& settings) {
         .default_value(std::string(""))
         .help("Database storage directory paths");
     program.add_argument("-th", "--threads").default_value(std::string("1")).help("Threads count");
+    program.add_argument("-cpu", "--cpu-list")
+        .default_value(std::string(""))
+        .help("CPUs to pin the threads to, like \"0-3,8\"");
+    program.add_argument("-numa", "--numa-policy")
+        .default_value(std::string("none"))
+        .help("Memory placement of the threads: none, local or interleave");
+    program.add_argument("-gt", "--generate-traces")
+        .default_value(std::string(""))
+        .help("Record the workloads into traces in the given directory and exit");
     program.add_argument("-fl", "--filter").default_value(std::string("")).help("Workloads filter");
     program.add_argument("-ri", "--run-index").default_value(std::string("0")).help("Run index in sequence");
     program.add_argument("-rc", "--runs-count").default_value(std::string("1")).help("Total runs count");
@@ -60,6 +75,9 @@ void parse_and_validate_args(int argc, char* argv[], settings_t& settings) {
     settings.workloads_file_path = program.get("workload-path");
     settings.results_file_path = program.get("results-path");
     settings.threads_count = std::stoi(program.get("threads"));
+    settings.cpu_list = program.get("cpu-list");
+    settings.numa_policy = parse_numa_policy(program.get("numa-policy"));
+    settings.traces_dir_path = program.get("generate-traces");
     settings.workload_filter = program.get("filter");
     settings.run_idx = std::stoi(program.get("run-index"));
     settings.runs_count = std::stoi(program.get("runs-count"));
@@ -84,6 +102,21 @@ void parse_and_validate_args(int argc, char* argv[], settings_t& settings) {
         fmt::print("Zero threads count specified\n");
         exit(1);
     }
+    if (!parse_cpu_list(settings.cpu_list, settings.cpus)) {
+        fmt::print("Invalid CPU list specified\n");
+        exit(1);
+    }
+    std::vector<size_t> allowed = allowed_cpus();
+    for (size_t cpu : settings.cpus) {
+        if (std::find(allowed.begin(), allowed.end(), cpu) == allowed.end()) {
+            fmt::print("CPU {} isn't available\n", cpu);
+            exit(1);
+        }
+    }
+    if (settings.numa_policy == numa_policy_t::unknown_k) {
+        fmt::print("Unknown NUMA policy specified\n");
+        exit(1);
+    }
     if (settings.runs_count == 0) {
         fmt::print("Zero total runs count specified\n");
         exit(1);
@@ -118,12 +151,30 @@ std::string build_title(settings_t const& settings, workloads_t const& workloads
     return fmt::format("{}", fmt::join(infos, " | "));
 }
 
+/**
+ * @brief Records the threads placement into the "context" section of the results.
+ */
+void add_placement_context(settings_t const& settings, placement_t const& placement) {
+    std::vector<size_t> nodes = cpus_nodes();
+    std::vector<size_t> threads_nodes;
+    for (size_t cpu : placement.threads_cpus)
+        threads_nodes.push_back(cpu < nodes.size() ? nodes[cpu] : 0);
+    size_t nodes_count = nodes.empty() ? 1 : *std::max_element(nodes.begin(), nodes.end()) + 1;
+
+    bm::AddCustomContext("cpu_list", settings.cpu_list.empty() ? "any" : settings.cpu_list);
+    bm::AddCustomContext("numa_policy", numa_policy_name(placement.numa_policy));
+    bm::AddCustomContext("numa_nodes", fmt::format("{}", nodes_count));
+    bm::AddCustomContext("threads_cpus", fmt::format("{}", fmt::join(placement.threads_cpus, ",")));
+    bm::AddCustomContext("threads_nodes", fmt::format("{}", fmt::join(threads_nodes, ",")));
+    bm::AddCustomContext("profiler_cpus", fmt::format("{}", fmt::join(placement.profiler_cpus, ",")));
+}
+
 template <typename func_at>
 inline void register_benchmark(std::string const& name, size_t threads_count, func_at func) {
     bm::RegisterBenchmark(name.c_str(), func)
         ->Threads(threads_count)
         ->Unit(bm::kMicrosecond)
-        ->UseRealTime()
+        ->UseManualTime()
         ->Repetitions(1)
         ->Iterations(1);
 }
@@ -170,7 +221,7 @@ void validate_workload(workload_t const& workload, [[maybe_unused]] size_t threa
     assert(threads_count > 0);
     assert(!workload.name.empty());
     assert(workload.db_records_count > 0);
-    assert(workload.db_operations_count > 0);
+    assert(workload.db_operations_count > 0 || workload.duration_seconds > 0);
 
     float proportion = 0;
     proportion += workload.upsert_proportion;
@@ -183,11 +234,16 @@ void validate_workload(workload_t const& workload, [[maybe_unused]] size_t threa
     proportion += workload.bulk_load_proportion;
     proportion += workload.range_select_proportion;
     proportion += workload.scan_proportion;
-    assert(proportion > 0.0 && proportion <= 1.0);
+    assert(!workload.trace_file_path.empty() || (proportion > 0.0 && proportion <= 1.0));
 
     assert(workload.value_length > 0);
 
     assert(workload.key_dist != distribution_kind_t::unknown_k);
+    assert(workload.key_hot_data_fraction > 0.0 && workload.key_hot_data_fraction <= 1.0);
+    assert(workload.key_hot_operations_fraction >= 0.0 && workload.key_hot_operations_fraction <= 1.0);
+    assert(workload.key_exponential_percentile > 0.0 && workload.key_exponential_percentile < 100.0);
+    assert(workload.key_exponential_fraction > 0.0);
+    assert(workload.key_normal_stddev > 0.0);
 
     assert(workload.batch_upsert_proportion == 0.0 ||
            (workload.batch_upsert_proportion > 0.0 && workload.batch_upsert_min_length > 0));
@@ -208,6 +264,22 @@ void validate_workload(workload_t const& workload, [[maybe_unused]] size_t threa
            (workload.range_select_proportion > 0.0 && workload.range_select_min_length > 0));
     assert(workload.range_select_min_length <= workload.range_select_max_length);
     assert(workload.range_select_max_length <= workload.db_records_count / threads_count);
+
+    assert(workload.transaction_min_ops <= workload.transaction_max_ops);
+    assert(workload.queue_depth <= 1 || !workload.transaction_max_ops);
+    assert(workload.trace_file_path.empty() || !workload.transaction_max_ops);
+    // Note: Inserting workloads reserve the keys of the warm-up by its operations count
+    assert(workload.warmup_seconds <= 0 || workload.db_warmup_operations_count ||
+           (workload.upsert_proportion != 1.0 && workload.batch_upsert_proportion != 1.0 &&
+            workload.bulk_load_proportion != 1.0));
+    // Note: Without the operations count the keys of inserting workloads can't be reserved
+    // and the drift of the normal distribution has no operations to spread over
+    assert(workload.db_operations_count ||
+           (workload.upsert_proportion != 1.0 && workload.batch_upsert_proportion != 1.0 &&
+            workload.bulk_load_proportion != 1.0 && workload.key_normal_drift == 0.0));
+    assert(!workload.open_loop || !workload.trace_file_path.empty());
+    assert(workload.replay_speedup > 0);
+    assert(workload.key_shift >= 0.0 && workload.key_shift < 1.0);
 }
 
 workloads_t filter_workloads(workloads_t const& workloads, std::string const& filter) {
@@ -219,7 +291,8 @@ workloads_t filter_workloads(workloads_t const& workloads, std::string const& fi
     std::vector<std::string> tokens = split(filter, ',');
     for (auto const& token : tokens) {
         for (auto const& workload : workloads) {
-            if (workload.name == token)
+            // Note: The name of a workload with phases selects all of them
+            if (workload.name == token || workload.phases_name == token)
                 filtered_workloads.push_back(workload);
         }
     }
@@ -235,26 +308,34 @@ std::vector<workload_t> split_workload_into_threads(workload_t const& workload,
     auto operations_count_per_thread = workload.db_operations_count / threads_count;
     auto leftover_records_count = workload.db_records_count % threads_count;
     auto leftover_operations_count = workload.db_operations_count % threads_count;
+    auto warmup_operations_count_per_thread = workload.db_warmup_operations_count / threads_count;
+    auto leftover_warmup_operations_count = workload.db_warmup_operations_count % threads_count;
 
-    auto start_key = workload.start_key;
+    // Note: Workloads, which only insert, split their fresh keys between the threads
+    auto start_key = only_inserts(workload) ? first_fresh_key(workload) : workload.start_key;
     for (size_t idx = 0; idx < threads_count; ++idx) {
         workload_t thread_workload = workload;
         thread_workload.records_count = records_count_per_thread + bool(leftover_records_count);
         thread_workload.operations_count = operations_count_per_thread + bool(leftover_operations_count);
-        thread_workload.operations_count = std::max(size_t(1), thread_workload.operations_count);
+        // Note: Zero stays for workloads bound by `duration_seconds` alone
+        if (workload.db_operations_count)
+            thread_workload.operations_count = std::max(size_t(1), thread_workload.operations_count);
+        thread_workload.warmup_operations_count =
+            warmup_operations_count_per_thread + bool(leftover_warmup_operations_count);
         thread_workload.start_key = start_key;
         workloads.push_back(thread_workload);
 
         leftover_records_count -= bool(leftover_records_count);
         leftover_operations_count -= bool(leftover_operations_count);
+        leftover_warmup_operations_count -= bool(leftover_warmup_operations_count);
 
-        if (workload.upsert_proportion == 1.0 || workload.batch_upsert_proportion == 1.0 ||
-            workload.bulk_load_proportion == 1.0) {
+        if (only_inserts(workload)) {
+            // Note: Keys inserted during the warm-up must not overlap the ones of the next thread
+            size_t operations_count = thread_workload.warmup_operations_count + thread_workload.operations_count;
             size_t new_records_count =
-                bool(workload.upsert_proportion) * thread_workload.operations_count +
-                bool(workload.bulk_load_proportion) * thread_workload.operations_count * workload.bulk_load_max_length +
-                bool(workload.batch_upsert_proportion) * thread_workload.operations_count *
-                    workload.batch_upsert_max_length;
+                bool(workload.upsert_proportion) * operations_count +
+                bool(workload.bulk_load_proportion) * operations_count * workload.bulk_load_max_length +
+                bool(workload.batch_upsert_proportion) * operations_count * workload.batch_upsert_max_length;
             start_key += new_records_count;
         }
         else
@@ -295,8 +376,28 @@ struct progress_t {
     size_t done_iterations = 0;
     size_t failed_iterations = 0;
     size_t last_printed_iterations = 0;
+    size_t last_printed_time = 0;
+    /**
+     * @brief Zero, if only `duration_seconds` bounds the workload.
+     */
     size_t total_iterations = 0;
 
+    size_t transaction_commits = 0;
+    size_t transaction_aborts = 0;
+    size_t transaction_retries = 0;
+
+    size_t values_verified = 0;
+    size_t values_mismatched = 0;
+
+    size_t late_operations = 0;
+
+    /**
+     * @brief Set by the first thread, which finds out `duration_seconds` have passed.
+     */
+    bool time_is_up = false;
+    size_t finished_threads = 0;
+    elapsed_time_t duration = elapsed_time_t(0);
+
     int64_t prev_ops_per_second = 0.0;
 
     static void print_db_open() {
@@ -335,15 +436,29 @@ struct progress_t {
         fflush(stdout);
     }
 
-    bool is_time_to_print() {
-        auto print_iterations_step = std::max(size_t(0.05 * total_iterations), size_t(1));
+    /**
+     * @brief Prints every 5% of the iterations or, without their total, every 5% of the duration.
+     * The latter reads the clock only once in a while, as it costs more than fast operations themselves.
+     */
+    template <typename elapsed_time_at>
+    bool is_time_to_print(elapsed_time_at const& elapsed_time) {
+        constexpr size_t time_check_step_k = 1024;
         auto done_its = atomic_load(done_iterations);
+        if (!total_iterations) {
+            if (done_its % time_check_step_k)
+                return false;
+            auto print_time_step = std::max(size_t(0.05 * duration.count()), size_t(1));
+            return size_t(elapsed_time().count()) - atomic_load(last_printed_time) >= print_time_step;
+        }
+        auto print_iterations_step = std::max(size_t(0.05 * total_iterations), size_t(1));
         return done_its - atomic_load(last_printed_iterations) >= print_iterations_step || done_its == total_iterations;
     }
 
     void print(std::string const& workload_name, elapsed_time_t operations_elapsed_time, elapsed_time_t elapsed_time) {
 
-        auto done_percent = 100.f * done_iterations / total_iterations;
+        auto done_percent = total_iterations ? 100.f * done_iterations / total_iterations : 0.f;
+        if (duration.count())
+            done_percent = std::max(done_percent, std::min(100.f, 100.f * elapsed_time.count() / duration.count()));
         auto fails_percent = failed_iterations * 100.0 / done_iterations;
         auto ops_per_second = entries_touched / std::chrono::duration<double>(operations_elapsed_time).count();
         auto opps_delta = int64_t(ops_per_second) - prev_ops_per_second;
@@ -370,6 +485,7 @@ struct progress_t {
         fflush(stdout);
 
         atomic_store(last_printed_iterations, done_iterations);
+        atomic_store(last_printed_time, size_t(elapsed_time.count()));
         atomic_store(prev_ops_per_second, int64_t(ops_per_second));
     }
 
@@ -379,75 +495,383 @@ struct progress_t {
         bytes_processed = 0;
         done_iterations = 0;
         last_printed_iterations = 0;
+        last_printed_time = 0;
         total_iterations = 0;
         prev_ops_per_second = 0;
+        transaction_commits = 0;
+        transaction_aborts = 0;
+        transaction_retries = 0;
+        values_verified = 0;
+        values_mismatched = 0;
+        late_operations = 0;
+        time_is_up = false;
+        finished_threads = 0;
+        duration = elapsed_time_t(0);
     }
 };
 
-void bench(bm::State& state, workload_t const& workload, db_t& db, data_accessor_t& data_accessor) {
+inline operation_result_t do_operation(worker_t& worker, operation_kind_t operation) {
+    switch (operation) {
+    case operation_kind_t::upsert_k: return worker.do_upsert();
+    case operation_kind_t::update_k: return worker.do_update();
+    case operation_kind_t::remove_k: return worker.do_remove();
+    case operation_kind_t::read_k: return worker.do_read();
+    case operation_kind_t::read_modify_write_k: return worker.do_read_modify_write();
+    case operation_kind_t::batch_upsert_k: return worker.do_batch_upsert();
+    case operation_kind_t::batch_read_k: return worker.do_batch_read();
+    case operation_kind_t::bulk_load_k: return worker.do_bulk_load();
+    case operation_kind_t::range_select_k: return worker.do_range_select();
+    case operation_kind_t::scan_k: return worker.do_scan();
+    default: throw exception_t("Unknown operation");
+    }
+}
+
+/**
+ * @brief Runs the operations of a single transaction, retrying it on conflicts.
+ * @return Whether the transaction was committed.
+ */
+bool do_transaction(workload_t const& workload,
+                    worker_t& worker,
+                    transaction_t& transaction,
+                    std::vector<operation_kind_t> const& operations,
+                    std::vector<operation_result_t>& results,
+                    progress_t& progress) {
+
+    worker.begin_transaction();
+    for (size_t attempt = 0;; ++attempt) {
+        results.clear();
+        operation_status_t status = operation_status_t::ok_k;
+        for (auto operation : operations) {
+            operation_result_t result = do_operation(worker, operation);
+            if (result.status == operation_status_t::conflict_k) {
+                status = result.status;
+                break;
+            }
+            results.push_back(result);
+        }
+
+        if (status == operation_status_t::ok_k)
+            status = transaction.commit();
+        else
+            transaction.rollback();
+
+        if (status == operation_status_t::ok_k) {
+            atomic_add_fetch(progress.transaction_commits, size_t(1));
+            worker.end_transaction();
+            return true;
+        }
+        atomic_add_fetch(progress.transaction_aborts, size_t(1));
+        if (status != operation_status_t::conflict_k || attempt == workload.transaction_max_retries) {
+            worker.end_transaction();
+            return false;
+        }
+
+        atomic_add_fetch(progress.transaction_retries, size_t(1));
+        worker.retry_transaction();
+    }
+}
+
+/**
+ * @brief Sleeps until shortly before the time and spins the rest, as sleeps overshoot by tens of microseconds.
+ */
+inline void wait_until(time_point_t time) {
+    constexpr auto spin_time_k = std::chrono::microseconds(100);
+    if (time - high_resolution_clock_t::now() > spin_time_k)
+        std::this_thread::sleep_until(time - spin_time_k);
+    while (high_resolution_clock_t::now() < time)
+        ;
+}
+
+/**
+ * @brief Runs the warm-up operations of a thread, which are neither timed nor counted.
+ * Replays start the warm-up from the beginning of the trace, so its first operations run twice.
+ * Note: Values are still verified, but the counts are dropped.
+ */
+void warm_up(workload_t const& workload,
+             worker_t& worker,
+             operation_chooser_t& chooser,
+             ucsb::timer_t& timer,
+             transaction_t* transaction,
+             trace_stream_t const* trace) {
+
+    if (!workload.warmup_operations_count && workload.warmup_seconds <= 0)
+        return;
+
+    // Note: Checking the clock after every operation would cost more than fast operations themselves
+    constexpr size_t time_check_step_k = 16;
+    auto const duration = std::chrono::duration<double>(workload.warmup_seconds);
+    auto const start_time = high_resolution_clock_t::now();
+    bool explicit_transactions = transaction && workload.transaction_max_ops;
+    std::vector<operation_kind_t> transaction_operations;
+    std::vector<operation_result_t> transaction_results;
+    progress_t transaction_progress; // Commits of the warm-up aren't reported
+
+    timer.start_warmup();
+    std::optional<trace_cursor_t> cursor;
+    for (size_t idx = 0, step = 0;; ++step) {
+        if (workload.warmup_operations_count && idx >= workload.warmup_operations_count)
+            break;
+        if (workload.warmup_seconds > 0 && step % time_check_step_k == 0 &&
+            high_resolution_clock_t::now() - start_time >= duration)
+            break;
+        if (explicit_transactions) {
+            // Note: Transactions have the lengths and retries of the measured ones
+            size_t transaction_length = std::max(worker.generate_transaction_length(), size_t(1));
+            if (workload.warmup_operations_count)
+                transaction_length = std::min(transaction_length, workload.warmup_operations_count - idx);
+            transaction_operations.clear();
+            for (size_t op_idx = 0; op_idx != transaction_length; ++op_idx)
+                transaction_operations.push_back(chooser.choose());
+            do_transaction(
+                workload, worker, *transaction, transaction_operations, transaction_results, transaction_progress);
+            idx += transaction_length;
+            continue;
+        }
+        ++idx;
+        if (!trace) {
+            do_operation(worker, chooser.choose());
+            continue;
+        }
+        if (!cursor || cursor->done())
+            cursor.emplace(*trace);
+        worker.do_traced(cursor->next());
+    }
+    worker.flush_upserts();
+    if (transaction && !explicit_transactions)
+        transaction->take_rolled_back_writes();
+    worker.take_verification_counts();
+    worker.take_failed_upserts();
+    timer.stop_warmup();
+}
+
+/**
+ * @brief A logical client of a thread in the `queue_depth` mode.
+ * Clients share the operations of the thread and keep taking them until none is left.
+ */
+template <typename next_traced_at, typename update_progress_at, typename time_is_up_at>
+async_client_t async_client(worker_t& worker,
+                            operation_chooser_t& chooser,
+                            next_traced_at* next_traced,
+                            async_scheduler_t& scheduler,
+                            size_t client,
+                            size_t& thread_iterations,
+                            update_progress_at& update_progress,
+                            time_is_up_at& time_is_up) {
+
+    while (thread_iterations && !time_is_up()) {
+        --thread_iterations;
+        bool is_last_iteration = !thread_iterations;
+
+        // Note: Only reads are suspended, the other operations complete right away
+        operation_result_t result;
+        trace_records_spanc_t records = next_traced ? (*next_traced)() : trace_records_spanc_t {};
+        operation_kind_t operation = next_traced ? operation_kind_t(records.front().operation) : chooser.choose();
+        if (operation != operation_kind_t::read_k)
+            result = next_traced ? worker.do_traced(records) : do_operation(worker, operation);
+        else if (next_traced)
+            result = co_await worker.do_read_async(client, scheduler, records.front().key);
+        else
+            result = co_await worker.do_read_async(client, scheduler);
+
+        // Coalesced upserts must reach the DB before the last thread flushes it
+        if (is_last_iteration) {
+            operation_result_t pending = worker.flush_upserts();
+            if (pending.status == operation_status_t::ok_k)
+                result.entries_touched += pending.entries_touched;
+        }
+
+        update_progress(result);
+    }
+}
+
+void bench(bm::State& state,
+           workload_t const& workload,
+           db_t& db,
+           data_accessor_t& data_accessor,
+           transaction_t* transaction,
+           placement_t const& placement,
+           bool with_probes,
+           trace_stream_t const* trace) {
 
     // Bench components
     auto chooser = create_operation_chooser(workload);
-    ucsb::timer_t timer(state);
-    worker_t worker(workload, data_accessor, timer);
+    ucsb::timer_t timer(state, with_probes);
+    worker_t worker(workload, data_accessor, timer, trace);
+    std::optional<trace_cursor_t> cursor;
+    if (trace)
+        cursor.emplace(*trace);
     std::atomic_bool do_flash = true;
+    bool explicit_transactions = transaction && workload.transaction_max_ops;
+    std::vector<operation_kind_t> transaction_operations;
+    std::vector<operation_result_t> transaction_results;
 
     // Monitoring
     cpu_profiler_t cpu_prof;    // Only one thread profiles
     mem_profiler_t mem_prof;    // Only one thread profiles
     static progress_t progress; // Shared between threads
 
+    warm_up(workload, worker, *chooser, timer, transaction, trace);
+
     // Bench initialization
     atomic_add_fetch(progress.total_iterations, workload.operations_count);
     if (state.thread_index() == 0) {
+        progress.duration = std::chrono::duration_cast<elapsed_time_t>(
+            std::chrono::duration<double>(std::max(workload.duration_seconds, 0.0)));
+        cpu_prof.pin(placement.profiler_cpus);
+        mem_prof.pin(placement.profiler_cpus);
         cpu_prof.start();
         mem_prof.start();
         progress.print_start(workload.name);
     }
 
+    auto update_progress = [&](operation_result_t result) {
+        bool success = result.status == operation_status_t::ok_k;
+        auto bytes_processed = size_t(success) * workload.value_length * result.entries_touched;
+        atomic_add_fetch(progress.entries_touched, size_t(success) * result.entries_touched);
+        // Note: Every upsert of a failed coalesced group is a failed iteration, not only the one, which wrote it
+        atomic_add_fetch(progress.failed_iterations, size_t(!success) + worker.take_failed_upserts());
+        atomic_add_fetch(progress.bytes_processed, bytes_processed);
+        // Note: Writes of implicit transactions were counted as done, until the DB rolled them back
+        if (transaction && !explicit_transactions) {
+            auto [rolled_back_operations, rolled_back_writes] = transaction->take_rolled_back_writes();
+            if (rolled_back_operations) {
+                atomic_sub_fetch(progress.entries_touched, rolled_back_writes);
+                atomic_sub_fetch(progress.bytes_processed, workload.value_length * rolled_back_writes);
+                atomic_add_fetch(progress.failed_iterations, rolled_back_operations);
+            }
+        }
+        auto done_iterations = atomic_add_fetch(progress.done_iterations, size_t(1));
+
+        if (progress.is_time_to_print([&] { return timer.elapsed_time(); }))
+            progress.print(workload.name, timer.operations_elapsed_time(), timer.elapsed_time());
+
+        // Last thread flushes the DB, without the total it is done after the time is up
+        bool only_once = true;
+        bool is_last_iteration = done_iterations == progress.total_iterations;
+        if (is_last_iteration && do_flash.compare_exchange_weak(only_once, false)) {
+            progress_t::print_db_flush();
+            db.flush();
+        }
+    };
+
+    // Note: Threads check the clock every few operations and the first one to see the time is up stops the others
+    constexpr size_t time_check_step_k = 16;
+    size_t time_checks = 0;
+    time_point_t deadline;
+    auto time_is_up = [&]() {
+        if (workload.duration_seconds <= 0)
+            return false;
+        if (atomic_load(progress.time_is_up))
+            return true;
+        if (++time_checks % time_check_step_k || high_resolution_clock_t::now() < deadline)
+            return false;
+        atomic_store(progress.time_is_up, true);
+        return true;
+    };
+
+    // Note: Schedules of open-loop replays start with the batch as well, when threads meet
+    time_point_t replay_start;
+    auto next_traced = [&]() {
+        trace_records_spanc_t records = cursor->next();
+        if (!workload.open_loop)
+            return records;
+        auto delay = std::chrono::nanoseconds(uint64_t(records.front().timestamp / workload.replay_speedup));
+        time_point_t due_time = replay_start + std::chrono::duration_cast<high_resolution_clock_t::duration>(delay);
+        if (high_resolution_clock_t::now() > due_time) {
+            atomic_add_fetch(progress.late_operations, size_t(1));
+            return records;
+        }
+        timer.pause();
+        wait_until(due_time);
+        timer.resume();
+        return records;
+    };
+
     // Bench
     timer.start();
-    while (state.KeepRunningBatch(workload.operations_count)) {
-        size_t thread_iterations = workload.operations_count;
-        while (thread_iterations) {
-            // Do operation
-            operation_result_t result;
-            auto operation = chooser->choose();
-            switch (operation) {
-            case operation_kind_t::upsert_k: result = worker.do_upsert(); break;
-            case operation_kind_t::update_k: result = worker.do_update(); break;
-            case operation_kind_t::remove_k: result = worker.do_remove(); break;
-            case operation_kind_t::read_k: result = worker.do_read(); break;
-            case operation_kind_t::read_modify_write_k: result = worker.do_read_modify_write(); break;
-            case operation_kind_t::batch_upsert_k: result = worker.do_batch_upsert(); break;
-            case operation_kind_t::batch_read_k: result = worker.do_batch_read(); break;
-            case operation_kind_t::bulk_load_k: result = worker.do_bulk_load(); break;
-            case operation_kind_t::range_select_k: result = worker.do_range_select(); break;
-            case operation_kind_t::scan_k: result = worker.do_scan(); break;
-            default: throw exception_t("Unknown operation"); break;
+    // Note: Without the operations count the budget is unbounded and only the deadline stops the threads
+    size_t const operations_budget =
+        workload.operations_count ? workload.operations_count : std::numeric_limits<size_t>::max();
+    while (state.KeepRunningBatch(std::max(workload.operations_count, size_t(1)))) {
+        size_t thread_iterations = operations_budget;
+        // Note: Counted from here, because threads only meet at the start of the batch
+        deadline = high_resolution_clock_t::now() + progress.duration;
+        replay_start = high_resolution_clock_t::now();
+        if (workload.queue_depth > 1 && !explicit_transactions) {
+            async_scheduler_t scheduler;
+            std::vector<async_client_t> clients;
+            clients.reserve(workload.queue_depth);
+            for (size_t client = 0; client != workload.queue_depth; ++client)
+                clients.push_back(async_client(worker,
+                                               *chooser,
+                                               cursor ? &next_traced : nullptr,
+                                               scheduler,
+                                               client,
+                                               thread_iterations,
+                                               update_progress,
+                                               time_is_up));
+            scheduler.run(clients, [&] { data_accessor.poll_completions(); });
+        }
+
+        while (thread_iterations && !time_is_up()) {
+            if (explicit_transactions) {
+                size_t transaction_length = worker.generate_transaction_length();
+                transaction_length = std::clamp(transaction_length, size_t(1), thread_iterations);
+                transaction_operations.clear();
+                for (size_t idx = 0; idx != transaction_length; ++idx)
+                    transaction_operations.push_back(chooser->choose());
+
+                // Note: Operations of a given up transaction are counted as failed
+                bool committed = do_transaction(workload,
+                                                worker,
+                                                *transaction,
+                                                transaction_operations,
+                                                transaction_results,
+                                                progress);
+                for (size_t idx = 0; idx != transaction_length; ++idx)
+                    update_progress(committed ? transaction_results[idx]
+                                              : operation_result_t {0, operation_status_t::conflict_k});
+
+                thread_iterations -= transaction_length;
+                continue;
             }
 
-            // Update progress
-            bool success = result.status == operation_status_t::ok_k;
-            auto bytes_processed = size_t(success) * workload.value_length * result.entries_touched;
-            atomic_add_fetch(progress.entries_touched, size_t(success) * result.entries_touched);
-            atomic_add_fetch(progress.failed_iterations, size_t(!success));
-            atomic_add_fetch(progress.bytes_processed, bytes_processed);
-            auto done_iterations = atomic_add_fetch(progress.done_iterations, size_t(1));
-
-            if (progress.is_time_to_print())
-                progress.print(workload.name, timer.operations_elapsed_time(), timer.elapsed_time());
-
-            // Last thread flushes the DB
-            bool only_once = true;
-            bool is_last_iteration = done_iterations == progress.total_iterations;
-            if (is_last_iteration && do_flash.compare_exchange_weak(only_once, false)) {
-                progress_t::print_db_flush();
-                db.flush();
+            // Do operation
+            operation_result_t result =
+                cursor ? worker.do_traced(next_traced()) : do_operation(worker, chooser->choose());
+
+            // Coalesced upserts must reach the DB before the last thread flushes it
+            if (thread_iterations == 1) {
+                operation_result_t pending = worker.flush_upserts();
+                if (pending.status == operation_status_t::ok_k)
+                    result.entries_touched += pending.entries_touched;
             }
 
+            update_progress(result);
             --thread_iterations;
         }
+
+        // Stopped by `duration_seconds`, so nobody reached the total and the last thread to stop flushes the DB
+        if (thread_iterations) {
+            operation_result_t pending = worker.flush_upserts();
+            bool success = pending.status == operation_status_t::ok_k;
+            atomic_add_fetch(progress.entries_touched, size_t(success) * pending.entries_touched);
+            atomic_add_fetch(progress.bytes_processed, size_t(success) * workload.value_length * pending.entries_touched);
+            atomic_add_fetch(progress.failed_iterations, worker.take_failed_upserts());
+        }
+        bool is_last_thread = atomic_add_fetch(progress.finished_threads, size_t(1)) == size_t(state.threads());
+        if (is_last_thread && atomic_load(progress.done_iterations) != progress.total_iterations) {
+            progress_t::print_db_flush();
+            db.flush();
+        }
+
+        // Note: Published before the threads meet at the end of the batch, so the first one sees all counts
+        if (workload.verify_values) {
+            auto [verified, mismatched] = worker.take_verification_counts();
+            atomic_add_fetch(progress.values_verified, verified);
+            atomic_add_fetch(progress.values_mismatched, mismatched);
+        }
+        timer.set_iteration_time();
     }
     timer.stop();
 
@@ -471,6 +895,20 @@ void bench(bm::State& state, workload_t const& workload, db_t& db, data_accessor
         state.counters["mem_avg(vm),bytes"] = bm::Counter(mem_prof.vm().avg, bm::Counter::kDefaults, bm::Counter::kIs1024);
         state.counters["processed,bytes"] = bm::Counter(progress.bytes_processed, bm::Counter::kDefaults, bm::Counter::kIs1024);
         state.counters["disk,bytes"] = bm::Counter(db.size_on_disk(), bm::Counter::kDefaults, bm::Counter::kIs1024);
+        if (explicit_transactions) {
+            state.counters["commits"] = bm::Counter(progress.transaction_commits);
+            state.counters["aborts"] = bm::Counter(progress.transaction_aborts);
+            state.counters["retries"] = bm::Counter(progress.transaction_retries);
+        }
+        if (workload.open_loop)
+            state.counters["late,%"] = bm::Counter(progress.late_operations * 100.0 / progress.done_iterations);
+        if (workload.verify_values) {
+            state.counters["verified"] = bm::Counter(progress.values_verified);
+            state.counters["mismatches"] = bm::Counter(progress.values_mismatched);
+        }
+        // Note: Engine-specific counters are sampled at the end of every workload
+        for (auto const& [name, value] : db.statistics())
+            state.counters[name] = bm::Counter(value);
 
         progress.clear();
     }
@@ -478,33 +916,134 @@ void bench(bm::State& state, workload_t const& workload, db_t& db, data_accessor
     // clang-format on
 }
 
-void bench(bm::State& state, workload_t const& workload, db_t& db, bool transactional, threads_fence_t& fence) {
-
-    if (state.thread_index() == 0) {
+void bench(bm::State& state,
+           workload_t const& workload,
+           db_t& db,
+           bool transactional,
+           placement_t const& placement,
+           bool with_probes,
+           trace_stream_t const* trace,
+           bool opens_db,
+           bool closes_db,
+           threads_fence_t& fence) {
+
+    // Note: Consecutive phases of a workload share the DB opened by the first one
+    if (state.thread_index() == 0 && opens_db) {
         progress_t::print_db_open();
+        // Note: Background threads of the DB shouldn't inherit the placement of the first thread
+        if (!unplace_this_thread(placement))
+            throw exception_t("Failed to reset the thread placement");
         std::string error;
         if (!db.open(error))
             throw exception_t(error);
     }
+    if (state.thread_index() == 0)
+        db.rebind_threads();
     fence.sync();
 
+    // Note: Worker buffers are allocated after this point, so they are first touched where they are used
+    if (!place_this_thread(placement, state.thread_index()))
+        throw exception_t("Failed to place the benchmark thread");
+
     if (transactional) {
         auto transaction = db.create_transaction();
         if (!transaction)
             throw exception_t("Failed to create DB transaction");
-        bench(state, workload, db, *transaction);
+        transaction->set_explicit_boundaries(workload.transaction_max_ops != 0);
+        bench(state, workload, db, *transaction, transaction.get(), placement, with_probes, trace);
     }
     else
-        bench(state, workload, db, db);
+        bench(state, workload, db, db, nullptr, placement, with_probes, trace);
 
     fence.sync();
-    if (state.thread_index() == 0) {
+    if (state.thread_index() == 0 && closes_db) {
         progress_t::print_db_close();
         db.close();
         progress_t::clear_last_print();
     }
 }
 
+/**
+ * @brief Maps the trace of a workload, if it replays one, and takes the operations count from it.
+ */
+std::unique_ptr<trace_t> open_trace(workload_t& workload, size_t threads_count) {
+    if (workload.trace_file_path.empty())
+        return nullptr;
+
+    auto trace = std::make_unique<trace_t>();
+    std::string error;
+    if (!trace->open(workload.trace_file_path, error))
+        throw exception_t(error);
+    if (trace->threads_count() != threads_count)
+        throw exception_t(fmt::format("Trace of {} was recorded for {} threads, not {}",
+                                      workload.name,
+                                      trace->threads_count(),
+                                      threads_count));
+
+    workload.db_operations_count = 0;
+    for (size_t idx = 0; idx != threads_count; ++idx) {
+        if (!trace->stream(idx).operations_count)
+            throw exception_t(fmt::format("Trace of {} has no operations for thread {}", workload.name, idx));
+        workload.db_operations_count += trace->stream(idx).operations_count;
+    }
+    return trace;
+}
+
+/**
+ * @brief Records the operations of every thread of the workloads into `<name>.trace` files,
+ * running the workers against a recorder instead of a DB.
+ */
+void generate_traces(std::vector<workloads_t> const& threads_workloads, fs::path const& dir_path) {
+    std::error_code ec;
+    fs::create_directories(dir_path, ec);
+    if (ec)
+        throw exception_t(fmt::format("Failed to create traces directory. path: {}", dir_path.string()));
+
+    for (auto const& splitted_workloads : threads_workloads) {
+        std::string const& workload_name = splitted_workloads.front().name;
+        if (!splitted_workloads.front().trace_file_path.empty()) {
+            fmt::print("Skipped {}, it already replays a trace\n", workload_name);
+            continue;
+        }
+        if (!splitted_workloads.front().db_operations_count) {
+            fmt::print("Skipped {}, it has no operations count to record\n", workload_name);
+            continue;
+        }
+
+        fs::path path = dir_path / fmt::format("{}.trace", workload_name);
+        trace_writer_t writer;
+        std::string error;
+        if (!writer.open(path, splitted_workloads.size(), error))
+            throw exception_t(error);
+
+        for (auto const& thread_workload : splitted_workloads) {
+            // Note: Coalescing and verification are options of the replay, not parts of the trace
+            workload_t workload = thread_workload;
+            workload.upsert_coalesce_length = 0;
+            workload.verify_values = false;
+            workload.zero_copy_reads = false;
+            workload.queue_depth = 0;
+
+            trace_recorder_t recorder(writer);
+            ucsb::timer_t timer;
+            timer.start();
+            worker_t worker(workload, recorder, timer);
+            auto chooser = create_operation_chooser(workload);
+            writer.begin_thread();
+            for (size_t idx = 0; idx != workload.operations_count; ++idx) {
+                operation_kind_t operation = chooser->choose();
+                recorder.begin(operation);
+                do_operation(worker, operation);
+            }
+            timer.stop();
+        }
+
+        if (!writer.close(error))
+            throw exception_t(error);
+        fmt::print("Generated trace: {}\n", path.string());
+    }
+}
+
 void wait_for_signal(int signal) {
     int sig;
     sigset_t set;
@@ -600,10 +1139,21 @@ int main(int argc, char** argv) {
             return 1;
         }
         std::vector<workloads_t> threads_workloads;
-        for (auto const& workload : workloads) {
+        std::vector<std::unique_ptr<trace_t>> traces;
+        for (auto& workload : workloads) {
+            std::unique_ptr<trace_t> trace = open_trace(workload, settings.threads_count);
             validate_workload(workload, settings.threads_count);
             std::vector<workload_t> splitted_workloads = split_workload_into_threads(workload, settings.threads_count);
+            if (trace)
+                for (size_t idx = 0; idx != splitted_workloads.size(); ++idx)
+                    splitted_workloads[idx].operations_count = trace->stream(idx).operations_count;
             threads_workloads.push_back(splitted_workloads);
+            traces.push_back(std::move(trace));
+        }
+
+        if (!settings.traces_dir_path.empty()) {
+            generate_traces(threads_workloads, settings.traces_dir_path);
+            return 0;
         }
 
         // Setup DB
@@ -617,14 +1167,35 @@ int main(int argc, char** argv) {
         db->set_config(settings.db_config_file_path, settings.db_main_dir_path, settings.db_storage_dir_paths, hints);
 
         threads_fence_t fence(settings.threads_count);
+        placement_t placement = make_placement(settings.cpus, settings.threads_count, settings.numa_policy);
+        add_placement_context(settings, placement);
 
         // Register benchmarks
-        for (auto const& splitted_workloads : threads_workloads) {
+        for (size_t workload_idx = 0; workload_idx != threads_workloads.size(); ++workload_idx) {
+            auto const& splitted_workloads = threads_workloads[workload_idx];
+            trace_t const* trace = traces[workload_idx].get();
             std::string workload_name = splitted_workloads.front().name;
-            register_benchmark(workload_name, settings.threads_count, [&](bm::State& state) {
+            std::string const& phases_name = splitted_workloads.front().phases_name;
+            bool opens_db = phases_name.empty() || workload_idx == 0 ||
+                            threads_workloads[workload_idx - 1].front().phases_name != phases_name;
+            bool closes_db = phases_name.empty() || workload_idx + 1 == threads_workloads.size() ||
+                             threads_workloads[workload_idx + 1].front().phases_name != phases_name;
+            auto body = [&, trace, opens_db, closes_db](bm::State& state) {
                 auto const& workload = splitted_workloads[state.thread_index()];
-                bench(state, workload, *db, settings.transactional, fence);
-            });
+                trace_stream_t const* stream = trace ? &trace->stream(state.thread_index()) : nullptr;
+                // Note: eBPF probes are attached only in the lazy mode
+                bench(state,
+                      workload,
+                      *db,
+                      settings.transactional,
+                      placement,
+                      settings.lazy,
+                      stream,
+                      opens_db,
+                      closes_db,
+                      fence);
+            };
+            register_benchmark(workload_name, settings.threads_count, body);
         }
 
         std::string title = build_title(settings, workloads, db->info());
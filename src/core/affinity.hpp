@@ -0,0 +1,213 @@
+#pragma once
+
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <fmt/format.h>
+
+#include "src/core/types.hpp"
+#include "src/core/helper.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief Where the memory of a benchmark thread is allocated.
+ */
+enum class numa_policy_t {
+    none_k,       // Leaves the system default, usually the node of the first touch
+    local_k,      // Always the node of the CPU the thread runs on
+    interleave_k, // Round-robin over the nodes of all the benchmark CPUs
+    unknown_k,
+};
+
+inline numa_policy_t parse_numa_policy(std::string const& name) {
+    numa_policy_t policy = numa_policy_t::unknown_k;
+    if (name == "none")
+        policy = numa_policy_t::none_k;
+    else if (name == "local")
+        policy = numa_policy_t::local_k;
+    else if (name == "interleave")
+        policy = numa_policy_t::interleave_k;
+    return policy;
+}
+
+inline char const* numa_policy_name(numa_policy_t policy) {
+    switch (policy) {
+    case numa_policy_t::none_k: return "none";
+    case numa_policy_t::local_k: return "local";
+    case numa_policy_t::interleave_k: return "interleave";
+    default: return "unknown";
+    }
+}
+
+/**
+ * @brief Parses a Linux-style CPU list, like "0-3,8,10-11", keeping the order of its entries.
+ */
+inline bool parse_cpu_list(std::string const& str, std::vector<size_t>& cpus) {
+    cpus.clear();
+    for (auto const& token : split(str, ',')) {
+        size_t dash = token.find('-');
+        try {
+            size_t first = std::stoul(token.substr(0, dash));
+            size_t last = dash == std::string::npos ? first : std::stoul(token.substr(dash + 1));
+            if (last < first || last >= CPU_SETSIZE)
+                return false;
+            for (size_t cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        catch (std::exception const&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Maps every CPU to its NUMA node, reading the topology from sysfs.
+ * CPUs of machines without NUMA are all mapped to node zero.
+ */
+inline std::vector<size_t> cpus_nodes() {
+    std::vector<size_t> nodes(std::max<long>(sysconf(_SC_NPROCESSORS_CONF), 1), 0);
+    fs::path const nodes_path = "/sys/devices/system/node";
+    for (size_t node = 0; fs::exists(nodes_path / fmt::format("node{}", node)); ++node) {
+        std::ifstream ifstream(nodes_path / fmt::format("node{}", node) / "cpulist");
+        std::string str;
+        std::vector<size_t> cpus;
+        if (!std::getline(ifstream, str) || !parse_cpu_list(str, cpus))
+            continue;
+        for (size_t cpu : cpus) {
+            if (cpu >= nodes.size())
+                nodes.resize(cpu + 1, 0);
+            nodes[cpu] = node;
+        }
+    }
+    return nodes;
+}
+
+inline bool pin_thread(pthread_t thread, std::vector<size_t> const& cpus) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (size_t cpu : cpus)
+        CPU_SET(cpu, &cpu_set);
+    return pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set) == 0;
+}
+
+/**
+ * @brief CPUs the calling thread is allowed to run on.
+ */
+inline std::vector<size_t> allowed_cpus() {
+    std::vector<size_t> cpus;
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+        return cpus;
+    for (size_t cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &cpu_set))
+            cpus.push_back(cpu);
+    return cpus;
+}
+
+/**
+ * @brief Applies the policy to the future allocations of the calling thread.
+ * Note: Uses the raw syscall to avoid depending on `libnuma`.
+ */
+inline bool set_numa_policy(numa_policy_t policy, std::vector<size_t> const& nodes) {
+    switch (policy) {
+    case numa_policy_t::none_k: return true;
+    case numa_policy_t::local_k: return syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) == 0;
+    case numa_policy_t::interleave_k: {
+        constexpr size_t bits_k = sizeof(unsigned long) * 8;
+        size_t nodes_max = nodes.empty() ? 0 : *std::max_element(nodes.begin(), nodes.end());
+        std::vector<unsigned long> mask(nodes_max / bits_k + 1, 0);
+        for (size_t node : nodes)
+            mask[node / bits_k] |= 1ul << (node % bits_k);
+        return syscall(SYS_set_mempolicy, MPOL_INTERLEAVE, mask.data(), mask.size() * bits_k + 1) == 0;
+    }
+    default: return false;
+    }
+}
+
+/**
+ * @brief Placement of the benchmark threads and the memory they allocate.
+ */
+struct placement_t {
+    /**
+     * @brief CPUs the process was allowed to use before any pinning.
+     */
+    std::vector<size_t> process_cpus;
+    /**
+     * @brief CPUs of the benchmark threads by their indexes, empty if they aren't pinned.
+     */
+    std::vector<size_t> threads_cpus;
+    /**
+     * @brief CPUs of the profiler threads. A single CPU unused by the benchmark threads,
+     * if there is one, otherwise all the CPUs the process was allowed to use.
+     * Note: Without it the profilers would inherit the CPU of the thread starting them.
+     */
+    std::vector<size_t> profiler_cpus;
+    numa_policy_t numa_policy = numa_policy_t::none_k;
+    /**
+     * @brief NUMA nodes of the benchmark CPUs, or all the nodes if CPUs aren't given.
+     */
+    std::vector<size_t> numa_nodes;
+};
+
+/**
+ * @brief Assigns CPUs to threads in the order of the list, wrapping around if there are less
+ * CPUs than threads. The first CPU left after the benchmark threads goes to the profilers.
+ */
+inline placement_t make_placement(std::vector<size_t> const& cpus, size_t threads_count, numa_policy_t policy) {
+    placement_t placement;
+    placement.process_cpus = allowed_cpus();
+    placement.numa_policy = policy;
+    if (!cpus.empty()) {
+        for (size_t idx = 0; idx != threads_count; ++idx)
+            placement.threads_cpus.push_back(cpus[idx % cpus.size()]);
+        if (cpus.size() > threads_count)
+            placement.profiler_cpus.push_back(cpus[threads_count]);
+        else
+            placement.profiler_cpus = placement.process_cpus;
+    }
+
+    std::vector<size_t> nodes = cpus_nodes();
+    if (placement.threads_cpus.empty())
+        placement.numa_nodes = nodes;
+    else
+        for (size_t cpu : placement.threads_cpus)
+            placement.numa_nodes.push_back(cpu < nodes.size() ? nodes[cpu] : 0);
+    std::sort(placement.numa_nodes.begin(), placement.numa_nodes.end());
+    placement.numa_nodes.erase(std::unique(placement.numa_nodes.begin(), placement.numa_nodes.end()),
+                               placement.numa_nodes.end());
+    return placement;
+}
+
+/**
+ * @brief Pins the calling benchmark thread and sets its memory policy.
+ * Must be called before the thread allocates its buffers, so they are first touched in place.
+ */
+inline bool place_this_thread(placement_t const& placement, size_t thread_idx) {
+    if (!placement.threads_cpus.empty() && !pin_thread(pthread_self(), {placement.threads_cpus[thread_idx]}))
+        return false;
+    return set_numa_policy(placement.numa_policy, placement.numa_nodes);
+}
+
+/**
+ * @brief Lets the calling thread run and allocate anywhere again.
+ * Used before opening a DB, so the threads it spawns don't inherit the placement of a benchmark thread.
+ */
+inline bool unplace_this_thread(placement_t const& placement) {
+    if (!placement.threads_cpus.empty() && !pin_thread(pthread_self(), placement.process_cpus))
+        return false;
+    if (placement.numa_policy == numa_policy_t::none_k)
+        return true;
+    return syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+}
+
+} // namespace ucsb
\ No newline at end of file
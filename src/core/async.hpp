@@ -0,0 +1,117 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <utility>
+#include <exception>
+#include <coroutine>
+
+#include "src/core/types.hpp"
+#include "src/core/operation.hpp"
+
+namespace ucsb {
+
+class async_scheduler_t;
+
+/**
+ * @brief A single read, which may complete after it was submitted to the engine.
+ * Engines must complete it on the submitting thread: either right away
+ * or later, when the scheduler polls them.
+ */
+struct async_read_t {
+    key_t key = 0;
+    value_span_t value;
+    operation_result_t result;
+    bool done = false;
+
+    /**
+     * @brief The logical client waiting for the read, if it was suspended.
+     */
+    std::coroutine_handle<> awaiting;
+    async_scheduler_t* scheduler = nullptr;
+
+    inline void complete(operation_result_t result) noexcept;
+};
+
+/**
+ * @brief A logical client of the benchmark, a coroutine issuing operations one after another.
+ * It's started and resumed only by the `async_scheduler_t`.
+ */
+class async_client_t {
+  public:
+    struct promise_type {
+        std::exception_ptr exception;
+
+        async_client_t get_return_object() noexcept {
+            return async_client_t(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+
+    inline async_client_t(async_client_t&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    async_client_t(async_client_t const&) = delete;
+    ~async_client_t() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    inline std::coroutine_handle<promise_type> handle() const noexcept { return handle_; }
+
+  private:
+    inline async_client_t(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief Runs many logical clients on a single thread.
+ * Clients are resumed one at a time, when all of them are waiting
+ * the engine is polled for completed requests.
+ */
+class async_scheduler_t {
+  public:
+    inline void schedule(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    /**
+     * @brief Runs all the clients until they are done.
+     * @param poll Called while there is no client to resume.
+     */
+    template <typename poll_at>
+    void run(std::vector<async_client_t>& clients, poll_at&& poll) {
+        for (auto& client : clients)
+            schedule(client.handle());
+
+        size_t done_count = 0;
+        while (done_count != clients.size()) {
+            while (!ready_.empty()) {
+                std::coroutine_handle<> handle = ready_.front();
+                ready_.pop_front();
+                handle.resume();
+            }
+
+            done_count = 0;
+            for (auto& client : clients) {
+                done_count += client.handle().done();
+                if (client.handle().promise().exception)
+                    std::rethrow_exception(client.handle().promise().exception);
+            }
+            if (done_count != clients.size())
+                poll();
+        }
+    }
+
+  private:
+    std::deque<std::coroutine_handle<>> ready_;
+};
+
+inline void async_read_t::complete(operation_result_t result) noexcept {
+    this->result = result;
+    done = true;
+    if (awaiting)
+        scheduler->schedule(std::exchange(awaiting, nullptr));
+}
+
+} // namespace ucsb
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <time.h>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace ucsb {
+
+using elapsed_time_t = std::chrono::nanoseconds;
+
+/**
+ * @brief A cheap monotonic clock for the hot paths of the benchmark.
+ * Reads the time stamp counter if it's invariant, so it ticks at a constant rate regardless
+ * of frequency scaling and sleep states. Otherwise falls back to `CLOCK_MONOTONIC_RAW`,
+ * which is still served by vDSO without a syscall.
+ */
+class cycle_clock_t {
+  public:
+    using ticks_t = uint64_t;
+
+    static inline ticks_t now() noexcept {
+#if defined(__x86_64__)
+        if (calibration_.invariant_tsc) {
+            unsigned int aux;
+            return __rdtscp(&aux);
+        }
+#endif
+        return monotonic_raw_ns();
+    }
+
+    static inline elapsed_time_t to_elapsed_time(ticks_t ticks) noexcept {
+        return elapsed_time_t(int64_t(double(ticks) * calibration_.ns_per_tick));
+    }
+
+    static inline bool uses_tsc() noexcept { return calibration_.invariant_tsc; }
+
+  private:
+    struct calibration_t {
+        bool invariant_tsc = false;
+        double ns_per_tick = 1.0;
+    };
+
+    static inline ticks_t monotonic_raw_ns() noexcept {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return ticks_t(ts.tv_sec) * 1'000'000'000 + ticks_t(ts.tv_nsec);
+    }
+
+    /**
+     * @brief Measures the TSC rate against `CLOCK_MONOTONIC_RAW` once, at the start of the process.
+     * Note: 10ms are enough to get the rate within a few parts per million.
+     */
+    static calibration_t calibrate() noexcept {
+        calibration_t calibration;
+#if defined(__x86_64__)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007)
+            return calibration;
+        __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+        if (!(edx & (1u << 8)))
+            return calibration;
+
+        constexpr ticks_t calibration_ns_k = 10'000'000;
+        unsigned int aux;
+        ticks_t start_ns = monotonic_raw_ns();
+        ticks_t start_ticks = __rdtscp(&aux);
+        ticks_t end_ns = start_ns;
+        while (end_ns - start_ns < calibration_ns_k)
+            end_ns = monotonic_raw_ns();
+        ticks_t end_ticks = __rdtscp(&aux);
+        if (end_ticks <= start_ticks)
+            return calibration;
+
+        calibration.invariant_tsc = true;
+        calibration.ns_per_tick = double(end_ns - start_ns) / double(end_ticks - start_ticks);
+#endif
+        return calibration;
+    }
+
+    static inline calibration_t const calibration_ = calibrate();
+};
+
+} // namespace ucsb
\ No newline at end of file
@@ -1,12 +1,20 @@
 #pragma once
 
 #include <set>
+#include <functional>
 
 #include "src/core/types.hpp"
 #include "src/core/operation.hpp"
+#include "src/core/async.hpp"
 
 namespace ucsb {
 
+/**
+ * @brief Receives a view to a value, which is owned by the engine and
+ * is only valid until the visitor returns.
+ */
+using value_visitor_t = std::function<void(value_spanc_t)>;
+
 /**
  * @brief A base class for data accessing: on DBs and Transactions state.
  *
@@ -31,6 +39,37 @@ class data_accessor_t {
     virtual operation_result_t remove(key_t key) = 0;
     virtual operation_result_t read(key_t key, value_span_t value) const = 0;
 
+    /**
+     * @brief Reads a value without copying it out of the engine, if the engine allows it.
+     * The `visitor` is called only for found entries with a view to the engine-owned memory.
+     * Helps to separate the cost of the final `memcpy` from the cost of the lookup itself.
+     *
+     * @param key The entry to find.
+     * @param value A buffer used by engines, which can't lend their memory. By default
+     * the value is copied into it, just like in `read`, and the visitor sees the copy.
+     * @param visitor A callback, which must not keep the view after returning.
+     */
+    virtual operation_result_t read_borrowed(key_t key, value_span_t value, value_visitor_t const& visitor) const {
+        operation_result_t result = read(key, value);
+        if (result.status == operation_status_t::ok_k)
+            visitor(value);
+        return result;
+    }
+
+    /**
+     * @brief Starts a read, which may complete later, letting a single thread keep
+     * many requests in flight. The engine must call `request.complete()` on this
+     * thread, either before returning or from `poll_completions()`.
+     * By default the read is blocking and completes right away.
+     */
+    virtual void submit_read(async_read_t& request) const { request.complete(read(request.key, request.value)); }
+
+    /**
+     * @brief Completes some of the submitted reads of the calling thread.
+     * Called when all the logical clients of a thread are waiting, so it may block.
+     */
+    virtual void poll_completions() const {}
+
     /**
      * @brief Performs many upsert at once in a batch-asynchronous fashion.
      *
@@ -3,6 +3,8 @@
 #include <set>
 #include <string>
 #include <memory>
+#include <vector>
+#include <utility>
 
 #include "src/core/types.hpp"
 #include "src/core/db_hint.hpp"
@@ -10,7 +12,40 @@
 
 namespace ucsb {
 
-using transaction_t = data_accessor_t;
+/**
+ * @brief Engine-specific named counters, like cache evictions or checkpoints.
+ */
+using db_statistics_t = std::vector<std::pair<std::string, double>>;
+
+/**
+ * @brief A base class for transactional benchmarks.
+ * A single object is reused by a thread for many consecutive transactions:
+ * both `commit` and `rollback` finish the current one and begin the next.
+ */
+class transaction_t : public data_accessor_t {
+  public:
+    virtual ~transaction_t() {}
+
+    /**
+     * @brief Returns `conflict_k` if the transaction was aborted by the DB,
+     * all its changes are discarded in that case.
+     */
+    virtual operation_status_t commit() = 0;
+    virtual void rollback() = 0;
+
+    /**
+     * @brief Tells whether the benchmark commits after every few operations itself.
+     * Otherwise all the operations of a thread form a single long transaction,
+     * which engines may commit in parts on their own.
+     */
+    virtual void set_explicit_boundaries(bool) {}
+
+    /**
+     * @brief Returns the counts of write operations and of their written entries lost since the last call,
+     * which were already reported as done, but rolled back with an implicit transaction.
+     */
+    virtual std::pair<size_t, size_t> take_rolled_back_writes() { return {0, 0}; }
+};
 
 /**
  * @brief A base class for benchmarking key-value stores.
@@ -29,6 +64,12 @@ class db_t : public data_accessor_t {
 
     virtual bool open(std::string& error) = 0;
     virtual void close() = 0;
+    /**
+     * @brief Called by a single thread before the threads of every benchmark start.
+     * Benchmarks start new threads even if they share the opened DB, so engines,
+     * which bind sessions to threads on first use, must hand them out anew.
+     */
+    virtual void rebind_threads() {}
 
     /**
      * @brief Returns high level description about the DB
@@ -60,6 +101,12 @@ class db_t : public data_accessor_t {
      */
     virtual size_t size_on_disk() const = 0;
 
+    /**
+     * @brief Samples the internal counters of the engine, if it exposes any.
+     * Those are reported next to the benchmark results.
+     */
+    virtual db_statistics_t statistics() const { return {}; }
+
     virtual std::unique_ptr<transaction_t> create_transaction() = 0;
 };
 
@@ -51,6 +51,9 @@ std::shared_ptr<db_t> make_db(db_brand_t db_brand, bool transactional) {
 #endif
 #if defined(UCSB_HAS_ROCKSDB)
         case db_brand_t::rocksdb_k: return std::make_shared<facebook::rocksdb_t>(facebook::db_mode_t::transactional_k);
+#endif
+#if defined(UCSB_HAS_WIREDTIGER)
+        case db_brand_t::wiredtiger_k: return std::make_shared<mongo::wiredtiger_t>();
 #endif
         default: break;
         }
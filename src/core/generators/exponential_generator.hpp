@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cmath>
+#include <random>
+#include <cassert>
+
+#include "src/core/generators/generator.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief YCSB-style exponential: values closer to `min` are exponentially more likely.
+ * `percentile` percents of the values fall into the first `fraction` of the range,
+ * values beyond the range are redrawn.
+ */
+class exponential_generator_t : public generator_gt<size_t> {
+  public:
+    static constexpr double percentile_k = 95;
+    static constexpr double fraction_k = 0.8571428571;
+
+    inline exponential_generator_t(size_t min,
+                                   size_t max,
+                                   double percentile = percentile_k,
+                                   double fraction = fraction_k)
+        : base_(min), items_count_(max - min + 1),
+          dist_(-std::log(1.0 - percentile / 100.0) / (items_count_ * fraction)), last_(0) {
+        assert(min <= max);
+        assert(percentile > 0 && percentile < 100);
+        generate();
+    }
+
+    inline size_t generate() override {
+        double offset = 0;
+        do {
+            offset = dist_(generator_);
+        } while (offset >= items_count_);
+        return last_ = base_ + size_t(offset);
+    }
+    inline size_t last() override { return last_; }
+
+  private:
+    size_t const base_;
+    size_t const items_count_;
+    std::mt19937_64 generator_;
+    std::exponential_distribution<double> dist_;
+    size_t last_;
+};
+
+} // namespace ucsb::core
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <random>
+#include <algorithm>
+#include <cassert>
+
+#include "src/core/generators/generator.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief YCSB-style hotspot: `hot_operations_fraction` of the values are uniformly
+ * drawn from the first `hot_data_fraction` of the range, the rest from the others.
+ */
+class hotspot_generator_t : public generator_gt<size_t> {
+  public:
+    inline hotspot_generator_t(size_t min, size_t max, double hot_data_fraction, double hot_operations_fraction)
+        : hot_operations_fraction_(hot_operations_fraction), last_(0) {
+        assert(min <= max);
+        size_t items_count = max - min + 1;
+        size_t hot_items_count = std::clamp<size_t>(size_t(items_count * hot_data_fraction), 1, items_count);
+        hot_ = std::uniform_int_distribution<size_t>(min, min + hot_items_count - 1);
+        // Note: If everything is hot, there is nothing cold to draw from
+        if (hot_items_count == items_count)
+            hot_operations_fraction_ = 1.0;
+        else
+            cold_ = std::uniform_int_distribution<size_t>(min + hot_items_count, max);
+        generate();
+    }
+
+    inline size_t generate() override {
+        if (operation_(generator_) < hot_operations_fraction_)
+            return last_ = hot_(generator_);
+        return last_ = cold_(generator_);
+    }
+    inline size_t last() override { return last_; }
+
+  private:
+    std::mt19937_64 generator_;
+    std::uniform_real_distribution<double> operation_;
+    std::uniform_int_distribution<size_t> hot_;
+    std::uniform_int_distribution<size_t> cold_;
+    double hot_operations_fraction_;
+    size_t last_;
+};
+
+} // namespace ucsb::core
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <cassert>
+
+#include "src/core/generators/generator.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief Normally distributed values around a center, which moves by `drift` after every value,
+ * so the hot set slides over the range. Both the values and the center wrap around the range.
+ */
+class normal_generator_t : public generator_gt<size_t> {
+  public:
+    inline normal_generator_t(size_t min, size_t max, double center, double stddev, double drift)
+        : base_(min), items_count_(max - min + 1), center_(center), drift_(drift), dist_(0.0, stddev), last_(0) {
+        assert(min <= max);
+        assert(stddev > 0);
+        generate();
+    }
+
+    inline size_t generate() override {
+        double offset = std::floor(center_ + dist_(generator_));
+        center_ = std::fmod(center_ + drift_, double(items_count_));
+        if (center_ < 0)
+            center_ += items_count_;
+        offset = std::fmod(offset, double(items_count_));
+        if (offset < 0)
+            offset += items_count_;
+        return last_ = base_ + std::min(size_t(offset), items_count_ - 1);
+    }
+    inline size_t last() override { return last_; }
+
+  private:
+    size_t const base_;
+    size_t const items_count_;
+    double center_;
+    double const drift_;
+    std::mt19937_64 generator_;
+    std::normal_distribution<double> dist_;
+    size_t last_;
+};
+
+} // namespace ucsb::core
\ No newline at end of file
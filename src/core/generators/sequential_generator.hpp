@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cassert>
+
+#include "src/core/generators/generator.hpp"
+
+namespace ucsb::core {
+
+/**
+ * @brief Walks the range in order, starting over from `min` after `max`.
+ * Unlike `counter_generator_t` it never leaves the range, so it fits reads of existing keys.
+ */
+class sequential_generator_t : public generator_gt<size_t> {
+  public:
+    inline sequential_generator_t(size_t min, size_t max) : min_(min), max_(max), last_(max) { assert(min <= max); }
+
+    inline size_t generate() override { return last_ = last_ == max_ ? min_ : last_ + 1; }
+    inline size_t last() override { return last_; }
+
+  private:
+    size_t const min_;
+    size_t const max_;
+    size_t last_;
+};
+
+} // namespace ucsb::core
\ No newline at end of file
@@ -12,6 +12,11 @@ inline at atomic_add_fetch(at& value, at delta) noexcept {
     return __atomic_add_fetch(&value, delta, __ATOMIC_RELAXED);
 }
 
+template <typename at>
+inline at atomic_sub_fetch(at& value, at delta) noexcept {
+    return __atomic_sub_fetch(&value, delta, __ATOMIC_RELAXED);
+}
+
 template <typename at>
 inline at atomic_load(at& value) noexcept {
     return __atomic_load_n(&value, __ATOMIC_RELAXED);
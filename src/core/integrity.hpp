@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#include "src/core/types.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief Software CRC32-C (Castagnoli), used if the CPU has no dedicated instructions.
+ */
+inline uint32_t crc32c_serial(uint32_t crc, std::byte const* data, size_t length) noexcept {
+    static std::array<uint32_t, 256> const table = [] {
+        std::array<uint32_t, 256> table;
+        for (uint32_t idx = 0; idx != 256; ++idx) {
+            uint32_t entry = idx;
+            for (size_t bit = 0; bit != 8; ++bit)
+                entry = (entry >> 1) ^ (0x82F63B78u & (0u - (entry & 1u)));
+            table[idx] = entry;
+        }
+        return table;
+    }();
+
+    for (size_t idx = 0; idx != length; ++idx)
+        crc = (crc >> 8) ^ table[(crc ^ uint32_t(data[idx])) & 0xFF];
+    return crc;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) inline uint32_t crc32c_sse42(uint32_t crc,
+                                                                std::byte const* data,
+                                                                size_t length) noexcept {
+    uint64_t crc64 = crc;
+    size_t idx = 0;
+    for (; idx + sizeof(uint64_t) <= length; idx += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + idx, sizeof(uint64_t));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = uint32_t(crc64);
+    for (; idx != length; ++idx)
+        crc = _mm_crc32_u8(crc, uint8_t(data[idx]));
+    return crc;
+}
+
+#elif defined(__ARM_FEATURE_CRC32)
+
+inline uint32_t crc32c_armv8(uint32_t crc, std::byte const* data, size_t length) noexcept {
+    size_t idx = 0;
+    for (; idx + sizeof(uint64_t) <= length; idx += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + idx, sizeof(uint64_t));
+        crc = __crc32cd(crc, word);
+    }
+    for (; idx != length; ++idx)
+        crc = __crc32cb(crc, uint8_t(data[idx]));
+    return crc;
+}
+
+#endif
+
+/**
+ * @brief Continues a CRC32-C computation, using SSE4.2 or ARMv8 CRC instructions when available.
+ */
+inline uint32_t crc32c_update(uint32_t crc, std::byte const* data, size_t length) noexcept {
+#if defined(__x86_64__)
+    static bool const has_sse42 = __builtin_cpu_supports("sse4.2");
+    return has_sse42 ? crc32c_sse42(crc, data, length) : crc32c_serial(crc, data, length);
+#elif defined(__ARM_FEATURE_CRC32)
+    return crc32c_armv8(crc, data, length);
+#else
+    return crc32c_serial(crc, data, length);
+#endif
+}
+
+/**
+ * @brief A header, which starts every value in the verification mode.
+ * The checksum covers the key, the length and the whole payload after the header,
+ * so a value returned for a wrong key or truncated by the engine is detected.
+ */
+struct value_header_t {
+    key_t key = 0;
+    value_length_t length = 0;
+    uint32_t checksum = 0;
+};
+
+static_assert(sizeof(value_header_t) == 16);
+
+inline uint32_t value_checksum(value_header_t header, std::byte const* payload, size_t payload_length) noexcept {
+    header.checksum = 0;
+    uint32_t crc = ~uint32_t(0);
+    crc = crc32c_update(crc, reinterpret_cast<std::byte const*>(&header), sizeof(header));
+    crc = crc32c_update(crc, payload, payload_length);
+    return ~crc;
+}
+
+/**
+ * @brief Writes the verification header into the beginning of a generated value.
+ * @param value Must be at least `sizeof(value_header_t)` bytes long.
+ */
+inline void stamp_value(key_t key, value_span_t value) noexcept {
+    value_header_t header;
+    header.key = key;
+    header.length = value_length_t(value.size());
+    header.checksum = value_checksum(header, value.data() + sizeof(header), value.size() - sizeof(header));
+    std::memcpy(value.data(), &header, sizeof(header));
+}
+
+/**
+ * @brief Checks a value read back from the DB.
+ *
+ * @param value A buffer starting with the value, which may be longer than the value itself.
+ * @param key The expected key, ignored if `nullptr`.
+ * @return The length of the value, or zero if it is corrupted.
+ */
+inline size_t verify_value(value_spanc_t value, key_t const* key) noexcept {
+    value_header_t header;
+    if (value.size() < sizeof(header))
+        return 0;
+    std::memcpy(&header, value.data(), sizeof(header));
+    if (header.length < sizeof(header) || header.length > value.size())
+        return 0;
+    if (key && header.key != *key)
+        return 0;
+    if (header.checksum != value_checksum(header, value.data() + sizeof(header), header.length - sizeof(header)))
+        return 0;
+    return header.length;
+}
+
+} // namespace ucsb
\ No newline at end of file
@@ -27,6 +27,10 @@ enum class operation_status_t : int {
     error_k = -1,
     not_found_k = -2,
     not_implemented_k = -3,
+    /**
+     * @brief The transaction must be rolled back and retried.
+     */
+    conflict_k = -4,
 };
 
 struct operation_result_t {
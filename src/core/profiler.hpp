@@ -8,6 +8,9 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <vector>
+
+#include "src/core/affinity.hpp"
 
 namespace ucsb {
 
@@ -41,6 +44,8 @@ class cpu_profiler_t {
         requests_count_ = 0;
         time_to_die_.store(false);
         thread_ = std::thread(&cpu_profiler_t::request_cpu_usage, this);
+        if (!cpus_.empty())
+            pin_thread(thread_.native_handle(), cpus_);
     }
     inline void stop() {
         if (time_to_die_.load())
@@ -55,6 +60,11 @@ class cpu_profiler_t {
 
     inline stats_t percent() const { return stats_; }
 
+    /**
+     * @brief Restricts the sampling thread to the given CPUs, starting from the next `start()`.
+     */
+    inline void pin(std::vector<size_t> const& cpus) { cpus_ = cpus; }
+
   private:
     inline void recalculate(float percent) {
         stats_.min = std::min(percent, stats_.min);
@@ -94,6 +104,7 @@ class cpu_profiler_t {
 
     std::thread thread_;
     std::atomic_bool time_to_die_;
+    std::vector<size_t> cpus_;
 
     stats_t stats_;
     size_t request_delay_;
@@ -136,6 +147,8 @@ class mem_profiler_t {
         requests_count_ = 0;
         time_to_die_.store(false);
         thread_ = std::thread(&mem_profiler_t::request_mem_usage, this);
+        if (!cpus_.empty())
+            pin_thread(thread_.native_handle(), cpus_);
     }
     inline void stop() {
         if (time_to_die_.load())
@@ -148,6 +161,11 @@ class mem_profiler_t {
     inline stats_t vm() const { return stats_vms_; }
     inline stats_t rss() const { return stats_rss_; }
 
+    /**
+     * @brief Restricts the sampling thread to the given CPUs, starting from the next `start()`.
+     */
+    inline void pin(std::vector<size_t> const& cpus) { cpus_ = cpus; }
+
   private:
     inline void recalculate(size_t vm, size_t rss) {
         stats_vms_.min = std::min(vm, stats_vms_.min);
@@ -188,6 +206,7 @@ class mem_profiler_t {
 
     std::thread thread_;
     std::atomic_bool time_to_die_;
+    std::vector<size_t> cpus_;
 
     stats_t stats_vms_;
     stats_t stats_rss_;
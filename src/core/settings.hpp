@@ -3,6 +3,7 @@
 #include <fstream>
 
 #include "src/core/types.hpp"
+#include "src/core/affinity.hpp"
 
 namespace ucsb {
 
@@ -17,6 +18,10 @@ struct settings_t {
     fs::path workloads_file_path;
     std::string workload_filter;
     size_t threads_count = 0;
+    std::string cpu_list;
+    std::vector<size_t> cpus;
+    numa_policy_t numa_policy = numa_policy_t::none_k;
+    fs::path traces_dir_path;
 
     fs::path results_file_path;
     size_t run_idx = 0;
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <mutex>
+#include <queue>
+#include <latch>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace ucsb {
+
+/**
+ * @brief A tiny fixed-size pool for splitting a single operation
+ * (like a large batch read) into parallel sub-tasks.
+ * The calling thread always participates, so a pool with zero
+ * threads degrades into a plain serial loop.
+ */
+class thread_pool_t {
+  public:
+    inline thread_pool_t(size_t threads_count) : time_to_die_(false) {
+        threads_.reserve(threads_count);
+        for (size_t i = 0; i != threads_count; ++i)
+            threads_.emplace_back(&thread_pool_t::work, this);
+    }
+    ~thread_pool_t() {
+        {
+            std::unique_lock lock(mutex_);
+            time_to_die_ = true;
+        }
+        condition_.notify_all();
+        for (auto& thread : threads_)
+            thread.join();
+    }
+
+    inline size_t threads_count() const noexcept { return threads_.size(); }
+
+    /**
+     * @brief Calls `func(idx)` for every `idx` in `[0, tasks_count)`
+     * and blocks until all of them are done.
+     */
+    template <typename func_at>
+    void parallel_for(size_t tasks_count, func_at&& func) {
+        if (tasks_count == 0)
+            return;
+
+        std::latch done(tasks_count - 1);
+        {
+            std::unique_lock lock(mutex_);
+            for (size_t idx = 1; idx != tasks_count; ++idx)
+                tasks_.push([&func, &done, idx]() {
+                    func(idx);
+                    done.count_down();
+                });
+        }
+        condition_.notify_all();
+
+        func(size_t(0));
+        done.wait();
+    }
+
+  private:
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                condition_.wait(lock, [this] { return time_to_die_ || !tasks_.empty(); });
+                if (time_to_die_ && tasks_.empty())
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool time_to_die_;
+};
+
+} // namespace ucsb
\ No newline at end of file
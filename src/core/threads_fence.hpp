@@ -1,39 +1,61 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 namespace ucsb {
 
 /**
  * @brief Synchronization primitive to isolate workers across
  * threads from operation on uninitialized or closing DB.
+ *
+ * Waiting threads spin only briefly and then sleep on a futex (through `std::atomic::wait`),
+ * so while the first thread opens or closes the DB, they don't take CPU from it
+ * and from its background threads, nor distort the CPU profile.
  */
 class threads_fence_t {
   public:
     inline threads_fence_t(size_t threads_count)
-        : threads_count_(threads_count), waiting_threads_count_(0), released_threads_count_(0) {}
+        : threads_count_(threads_count), waiting_threads_count_(0), generation_(0) {}
 
     inline void sync() {
-        while (released_threads_count_.load())
-            ;
-
-        ++waiting_threads_count_;
-        while (waiting_threads_count_.load() != threads_count_)
-            ;
-
-        ++released_threads_count_;
-        if (released_threads_count_.load() == threads_count_) {
-            size_t tmp_waiting = threads_count_;
-            size_t tmp_released = threads_count_;
-            waiting_threads_count_.compare_exchange_weak(tmp_waiting, size_t(0));
-            released_threads_count_.compare_exchange_weak(tmp_released, size_t(0));
+        uint32_t generation = generation_.load(std::memory_order_acquire);
+        if (waiting_threads_count_.fetch_add(1, std::memory_order_acq_rel) + 1 == threads_count_) {
+            // Note: Nobody can enter the next round before the generation changes
+            waiting_threads_count_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            generation_.notify_all();
+            return;
+        }
+
+        for (size_t spin = 0; spin != max_spins_k; ++spin) {
+            if (generation_.load(std::memory_order_acquire) != generation)
+                return;
+            cpu_relax();
         }
+        while (generation_.load(std::memory_order_acquire) == generation)
+            generation_.wait(generation, std::memory_order_acquire);
     }
 
   private:
+    // Note: Covers the short waits between workloads, a few tens of microseconds
+    static constexpr size_t max_spins_k = 4096;
+
+    static inline void cpu_relax() noexcept {
+#if defined(__x86_64__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
     size_t const threads_count_;
     std::atomic_size_t waiting_threads_count_;
-    std::atomic_size_t released_threads_count_;
+    std::atomic<uint32_t> generation_;
 };
 
 } // namespace ucsb
\ No newline at end of file
@@ -3,17 +3,21 @@
 #include <chrono>
 #include <benchmark/benchmark.h>
 
+#include "src/core/clock.hpp"
+
 namespace bm = benchmark;
 
 namespace ucsb {
 
 using high_resolution_clock_t = std::chrono::high_resolution_clock;
 using time_point_t = std::chrono::time_point<high_resolution_clock_t>;
-using elapsed_time_t = std::chrono::nanoseconds;
 
 /**
- * @brief Trivial Google Benchmark wrapper.
- * No added value here :)
+ * @brief Measures the time of the operations themselves, excluding the data preparation.
+ * It's reported to Google Benchmark as the manual time of the whole batch, because
+ * `bm::State::PauseTiming()` is too expensive to call around every batch operation.
+ *
+ * Note: eBPF uprobes attach to the `probe_*` markers, which are called only if probes are enabled.
  */
 class timer_t {
   public:
@@ -21,75 +25,113 @@ class timer_t {
         stopped_k,
         running_k,
         paused_k,
+        warming_up_k,
     };
 
-    inline timer_t(bm::State& bench) : bench_(&bench), state_(state_t::stopped_k) {}
+    inline timer_t(bm::State& bench, bool with_probes = false)
+        : bench_(&bench), with_probes_(with_probes), state_(state_t::stopped_k) {}
+    /**
+     * @brief Measures outside of a benchmark, like while recording traces. Nothing is reported.
+     */
+    inline timer_t() : bench_(nullptr), with_probes_(false), state_(state_t::stopped_k) {}
 
-    // Google benchmark timer methods
-    void __attribute__ ((noinline)) pause() {
-        bench_->PauseTiming();
+    inline void pause() {
+        if (state_ == state_t::warming_up_k)
+            return;
+        if (with_probes_)
+            probe_pause();
 
         assert(state_ == state_t::running_k);
-        recalculate_operations_elapsed_time();
+        operations_elapsed_ticks_ += cycle_clock_t::now() - operations_start_ticks_;
         state_ = state_t::paused_k;
     }
-    void __attribute__ ((noinline)) resume() {
+    inline void resume() {
+        if (state_ == state_t::warming_up_k)
+            return;
+
         assert(state_ == state_t::paused_k);
-        operations_start_time_ = high_resolution_clock_t::now();
+        operations_start_ticks_ = cycle_clock_t::now();
         state_ = state_t::running_k;
 
-        bench_->ResumeTiming();
+        if (with_probes_)
+            probe_resume();
     }
 
-    // Helper methods to calculate real time statistics
-    void __attribute__ ((noinline)) start() {
+    inline void start() {
         assert(state_ == state_t::stopped_k);
-        elapsed_time_ = elapsed_time_t(0);
-        operations_elapsed_time_ = elapsed_time_t(0);
-        auto now = high_resolution_clock_t::now();
-        start_time_ = now;
-        operations_start_time_ = now;
+        elapsed_ticks_ = 0;
+        operations_elapsed_ticks_ = 0;
+        auto now = cycle_clock_t::now();
+        start_ticks_ = now;
+        operations_start_ticks_ = now;
         state_ = state_t::running_k;
+
+        if (with_probes_)
+            probe_start();
     }
-    void __attribute__ ((noinline)) stop() {
+    inline void stop() {
+        if (with_probes_)
+            probe_stop();
+
         assert(state_ == state_t::running_k);
-        recalculate_operations_elapsed_time();
+        auto now = cycle_clock_t::now();
+        operations_elapsed_ticks_ += now - operations_start_ticks_;
+        elapsed_ticks_ = now - start_ticks_;
         state_ = state_t::stopped_k;
     }
-    inline auto operations_elapsed_time() {
-        if (state_ == state_t::running_k)
-            recalculate_operations_elapsed_time();
-        return operations_elapsed_time_;
+
+    /**
+     * @brief Operations of the warm-up aren't timed, so pausing and resuming is ignored.
+     */
+    inline void start_warmup() {
+        assert(state_ == state_t::stopped_k);
+        state_ = state_t::warming_up_k;
     }
-    inline auto elapsed_time() {
-        if (state_ != state_t::stopped_k)
-            recalculate_elapsed_time();
-        return elapsed_time_;
+    inline void stop_warmup() {
+        assert(state_ == state_t::warming_up_k);
+        state_ = state_t::stopped_k;
     }
 
-  private:
-    void recalculate_operations_elapsed_time() {
-        auto now = high_resolution_clock_t::now();
-        operations_elapsed_time_ += std::chrono::duration_cast<elapsed_time_t>(now - operations_start_time_);
-        operations_start_time_ = now;
+    /**
+     * @brief Reports the operations time so far as the time of the current benchmark iteration.
+     * Must be called before the batch loop of Google Benchmark ends.
+     */
+    inline void set_iteration_time() {
+        if (bench_)
+            bench_->SetIterationTime(std::chrono::duration<double>(operations_elapsed_time()).count());
     }
-    void recalculate_elapsed_time() {
-        auto now = high_resolution_clock_t::now();
-        elapsed_time_ += std::chrono::duration_cast<elapsed_time_t>(now - start_time_);
-        start_time_ = now;
+
+    inline elapsed_time_t operations_elapsed_time() const {
+        auto ticks = operations_elapsed_ticks_;
+        if (state_ == state_t::running_k)
+            ticks += cycle_clock_t::now() - operations_start_ticks_;
+        return cycle_clock_t::to_elapsed_time(ticks);
     }
+    inline elapsed_time_t elapsed_time() const {
+        auto ticks = elapsed_ticks_;
+        if (state_ == state_t::running_k || state_ == state_t::paused_k)
+            ticks = cycle_clock_t::now() - start_ticks_;
+        return cycle_clock_t::to_elapsed_time(ticks);
+    }
+
+  private:
+    // Note: Empty markers for eBPF uprobes, the asm keeps them from being optimized out
+    void __attribute__ ((noinline)) probe_start() { asm volatile(""); }
+    void __attribute__ ((noinline)) probe_pause() { asm volatile(""); }
+    void __attribute__ ((noinline)) probe_resume() { asm volatile(""); }
+    void __attribute__ ((noinline)) probe_stop() { asm volatile(""); }
 
     // Bench state
     bm::State* bench_;
+    bool with_probes_;
 
-    // Note: These are not needed if we were able to get elapsed times from bm::State
     state_t state_;
     //
-    time_point_t start_time_;
-    elapsed_time_t elapsed_time_;
+    cycle_clock_t::ticks_t start_ticks_ = 0;
+    cycle_clock_t::ticks_t elapsed_ticks_ = 0;
     //
-    time_point_t operations_start_time_;
-    elapsed_time_t operations_elapsed_time_;
+    cycle_clock_t::ticks_t operations_start_ticks_ = 0;
+    cycle_clock_t::ticks_t operations_elapsed_ticks_ = 0;
 };
 
 } // namespace ucsb
\ No newline at end of file
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <fmt/format.h>
+
+#include "src/core/types.hpp"
+#include "src/core/operation.hpp"
+#include "src/core/data_accessor.hpp"
+
+namespace ucsb {
+
+/**
+ * @brief A single entry of an operation trace.
+ * Operations over many keys, batches and bulk loads, take one record per key.
+ * Their first record has the number of keys in `length`, the others have zero.
+ */
+struct trace_record_t {
+    key_t key = 0;
+    /**
+     * @brief Nanoseconds since the start of the trace, when the operation was issued.
+     * Used only by open-loop replays, generated traces leave it zero.
+     */
+    uint64_t timestamp = 0;
+    value_length_t value_length = 0;
+    /**
+     * @brief Keys in a batch or bulk load, entries in a range select or a scan.
+     */
+    uint32_t length = 0;
+    uint32_t operation = 0;
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(trace_record_t) == 32);
+
+using trace_records_spanc_t = std::span<trace_record_t const>;
+
+/**
+ * @brief The file starts with this header, followed by one `trace_thread_t` per thread
+ * and then by the records of all threads, one thread after another.
+ */
+struct trace_header_t {
+    char magic[8] = {'U', 'C', 'S', 'B', 'T', 'R', 'C', '\0'};
+    uint32_t version = 1;
+    uint32_t threads_count = 0;
+};
+
+struct trace_thread_t {
+    /**
+     * @brief Offset of the first record of the thread from the start of the file, in bytes.
+     */
+    uint64_t offset = 0;
+    uint64_t records_count = 0;
+    uint64_t operations_count = 0;
+    /**
+     * @brief The longest batch or range select and the largest value of the thread,
+     * to size the buffers before replaying.
+     */
+    uint32_t max_length = 0;
+    value_length_t max_value_length = 0;
+};
+
+static_assert(sizeof(trace_header_t) == 16);
+static_assert(sizeof(trace_thread_t) == 32);
+
+inline bool is_multikey_operation(operation_kind_t operation) {
+    return operation == operation_kind_t::batch_upsert_k || operation == operation_kind_t::batch_read_k ||
+           operation == operation_kind_t::bulk_load_k;
+}
+
+/**
+ * @brief Number of records taken by the operation starting with the given record.
+ * Note: An empty batch still takes one record.
+ */
+inline size_t trace_operation_records(trace_record_t const& record) {
+    if (!is_multikey_operation(operation_kind_t(record.operation)))
+        return 1;
+    return std::max<size_t>(record.length, 1);
+}
+
+/**
+ * @brief Operations of a single thread, a view into a mapped trace.
+ */
+struct trace_stream_t {
+    trace_records_spanc_t records;
+    size_t operations_count = 0;
+    size_t max_length = 0;
+    size_t max_value_length = 0;
+};
+
+/**
+ * @brief Checks that the operations of the stream fit its records and the buffers sized by its thread,
+ * so replays neither read past the records nor write past the buffers.
+ */
+inline bool is_valid_stream(trace_stream_t const& stream) {
+    size_t operations_count = 0;
+    for (size_t offset = 0; offset != stream.records.size(); ++operations_count) {
+        trace_record_t const& head = stream.records[offset];
+        if (head.operation > uint32_t(operation_kind_t::scan_k))
+            return false;
+        // Note: Scans don't need buffers for all the entries they visit
+        if (operation_kind_t(head.operation) != operation_kind_t::scan_k && head.length > stream.max_length)
+            return false;
+        size_t count = trace_operation_records(head);
+        if (count > stream.records.size() - offset)
+            return false;
+        for (size_t idx = offset; idx != offset + count; ++idx)
+            if (stream.records[idx].value_length > stream.max_value_length)
+                return false;
+        offset += count;
+    }
+    return operations_count == stream.operations_count;
+}
+
+/**
+ * @brief Walks the operations of a stream one by one, prefetching the upcoming records.
+ */
+class trace_cursor_t {
+  public:
+    inline trace_cursor_t(trace_stream_t const& stream) noexcept : records_(stream.records), offset_(0) {}
+
+    inline bool done() const noexcept { return offset_ == records_.size(); }
+
+    inline trace_records_spanc_t next() noexcept {
+        // Note: Four cache lines ahead covers the latency of a page cache hit, but not of a major fault
+        constexpr size_t prefetch_distance_k = 8;
+        if (offset_ + prefetch_distance_k < records_.size())
+            __builtin_prefetch(records_.data() + offset_ + prefetch_distance_k);
+
+        size_t count = std::min(trace_operation_records(records_[offset_]), records_.size() - offset_);
+        trace_records_spanc_t records = records_.subspan(offset_, count);
+        offset_ += count;
+        return records;
+    }
+
+  private:
+    trace_records_spanc_t records_;
+    size_t offset_;
+};
+
+/**
+ * @brief A trace file mapped into memory, read-only.
+ */
+class trace_t {
+  public:
+    inline trace_t() noexcept : data_(nullptr), size_(0) {}
+    trace_t(trace_t const&) = delete;
+    ~trace_t() { close(); }
+
+    inline bool open(fs::path const& path, std::string& error);
+    inline void close();
+
+    inline size_t threads_count() const noexcept { return streams_.size(); }
+    inline trace_stream_t const& stream(size_t thread_idx) const noexcept { return streams_[thread_idx]; }
+
+  private:
+    void* data_;
+    size_t size_;
+    std::vector<trace_stream_t> streams_;
+};
+
+inline bool trace_t::open(fs::path const& path, std::string& error) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = fmt::format("Failed to open trace: {}", path.string());
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || size_t(file_stat.st_size) < sizeof(trace_header_t)) {
+        ::close(fd);
+        error = fmt::format("Invalid trace: {}", path.string());
+        return false;
+    }
+    size_ = file_stat.st_size;
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        size_ = 0;
+        error = fmt::format("Failed to map trace: {}", path.string());
+        return false;
+    }
+    madvise(data_, size_, MADV_SEQUENTIAL);
+
+    auto bytes = reinterpret_cast<std::byte const*>(data_);
+    trace_header_t header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, trace_header_t().magic, sizeof(header.magic)) != 0 ||
+        header.version != trace_header_t().version ||
+        sizeof(header) + header.threads_count * sizeof(trace_thread_t) > size_) {
+        close();
+        error = fmt::format("Invalid trace header: {}", path.string());
+        return false;
+    }
+
+    auto threads = reinterpret_cast<trace_thread_t const*>(bytes + sizeof(header));
+    for (size_t idx = 0; idx != header.threads_count; ++idx) {
+        trace_thread_t const& thread = threads[idx];
+        if (thread.offset % alignof(trace_record_t) ||
+            thread.offset + thread.records_count * sizeof(trace_record_t) > size_) {
+            close();
+            error = fmt::format("Invalid trace thread {}: {}", idx, path.string());
+            return false;
+        }
+        trace_stream_t stream;
+        stream.records = trace_records_spanc_t(reinterpret_cast<trace_record_t const*>(bytes + thread.offset),
+                                               thread.records_count);
+        stream.operations_count = thread.operations_count;
+        stream.max_length = thread.max_length;
+        stream.max_value_length = thread.max_value_length;
+        if (!is_valid_stream(stream)) {
+            close();
+            error = fmt::format("Invalid trace records of thread {}: {}", idx, path.string());
+            return false;
+        }
+        streams_.push_back(stream);
+    }
+    return true;
+}
+
+inline void trace_t::close() {
+    if (data_)
+        munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+    streams_.clear();
+}
+
+/**
+ * @brief Writes a trace thread by thread, the threads table is filled in when it's closed.
+ */
+class trace_writer_t {
+  public:
+    inline trace_writer_t() noexcept : file_(nullptr) {}
+    trace_writer_t(trace_writer_t const&) = delete;
+    ~trace_writer_t() {
+        if (file_)
+            std::fclose(file_);
+    }
+
+    inline bool open(fs::path const& path, size_t threads_count, std::string& error);
+    inline bool close(std::string& error);
+
+    /**
+     * @brief Starts the records of the next thread.
+     */
+    inline void begin_thread();
+    /**
+     * @brief Failures are reported once the trace is closed.
+     */
+    inline void append(trace_record_t const& record);
+
+  private:
+    std::FILE* file_;
+    bool failed_ = false;
+    fs::path path_;
+    size_t threads_count_ = 0;
+    std::vector<trace_thread_t> threads_;
+    uint64_t offset_ = 0;
+    size_t left_records_ = 0;
+};
+
+inline bool trace_writer_t::open(fs::path const& path, size_t threads_count, std::string& error) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error = fmt::format("Failed to create trace: {}", path.string());
+        return false;
+    }
+    path_ = path;
+    threads_count_ = threads_count;
+    threads_.clear();
+
+    // Note: The threads table is a placeholder until the counts are known
+    trace_header_t header;
+    header.threads_count = threads_count;
+    std::vector<trace_thread_t> table(threads_count);
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1 ||
+        std::fwrite(table.data(), sizeof(trace_thread_t), table.size(), file_) != table.size()) {
+        std::fclose(file_);
+        file_ = nullptr;
+        error = fmt::format("Failed to write trace: {}", path.string());
+        return false;
+    }
+    failed_ = false;
+    offset_ = sizeof(header) + threads_count * sizeof(trace_thread_t);
+    return true;
+}
+
+inline void trace_writer_t::begin_thread() {
+    trace_thread_t thread;
+    thread.offset = offset_;
+    threads_.push_back(thread);
+    left_records_ = 0;
+}
+
+inline void trace_writer_t::append(trace_record_t const& record) {
+    trace_thread_t& thread = threads_.back();
+    // Note: Records after the head of a batch belong to the same operation
+    if (!left_records_) {
+        left_records_ = trace_operation_records(record);
+        ++thread.operations_count;
+        // Note: Scans don't need buffers for all the entries they visit
+        if (operation_kind_t(record.operation) != operation_kind_t::scan_k)
+            thread.max_length = std::max(thread.max_length, record.length);
+    }
+    --left_records_;
+    thread.max_value_length = std::max(thread.max_value_length, record.value_length);
+    ++thread.records_count;
+
+    failed_ |= std::fwrite(&record, sizeof(record), 1, file_) != 1;
+    offset_ += sizeof(record);
+}
+
+inline bool trace_writer_t::close(std::string& error) {
+    threads_.resize(threads_count_);
+    bool ok = !failed_ && std::fseek(file_, sizeof(trace_header_t), SEEK_SET) == 0 &&
+              std::fwrite(threads_.data(), sizeof(trace_thread_t), threads_.size(), file_) == threads_.size();
+    ok &= std::fclose(file_) == 0;
+    file_ = nullptr;
+    if (!ok)
+        error = fmt::format("Failed to write trace: {}", path_.string());
+    return ok;
+}
+
+/**
+ * @brief Records the operations issued by a worker instead of executing them.
+ * Every operation must be announced with `begin()`, so the read and the update
+ * of a read-modify-write land in a single record.
+ */
+class trace_recorder_t : public data_accessor_t {
+  public:
+    inline trace_recorder_t(trace_writer_t& writer) noexcept : writer_(&writer) {}
+
+    inline void begin(operation_kind_t operation) noexcept {
+        operation_ = operation;
+        recorded_ = false;
+    }
+
+    operation_result_t upsert(key_t key, value_spanc_t value) override { return record(key, value.size(), 1); }
+    operation_result_t update(key_t key, value_spanc_t value) override {
+        if (operation_ == operation_kind_t::read_modify_write_k && recorded_) {
+            last_.value_length = value.size();
+            return flush();
+        }
+        return record(key, value.size(), 1);
+    }
+    operation_result_t remove(key_t key) override { return record(key, 0, 1); }
+    operation_result_t read(key_t key, value_span_t) const override {
+        // Note: The update of a read-modify-write completes its record
+        if (operation_ == operation_kind_t::read_modify_write_k) {
+            last_ = {key, 0, 0, 1, uint32_t(operation_), 0};
+            recorded_ = true;
+            return {1, operation_status_t::ok_k};
+        }
+        return record(key, 0, 1);
+    }
+
+    operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t, value_lengths_spanc_t sizes) override {
+        return record_batch(keys, sizes);
+    }
+    operation_result_t batch_read(keys_spanc_t keys, values_span_t) const override {
+        return record_batch(keys, {});
+    }
+
+    operation_result_t bulk_load(keys_spanc_t keys, values_spanc_t, value_lengths_spanc_t sizes) override {
+        return record_batch(keys, sizes);
+    }
+
+    operation_result_t range_select(key_t key, size_t length, values_span_t) const override {
+        return record(key, 0, length);
+    }
+    operation_result_t scan(key_t key, size_t length, value_span_t) const override {
+        return record(key, 0, length);
+    }
+
+  private:
+    inline operation_result_t record(key_t key, size_t value_length, size_t length) const {
+        last_ = {key, 0, value_length_t(value_length), uint32_t(length), uint32_t(operation_), 0};
+        recorded_ = true;
+        return flush();
+    }
+    inline operation_result_t flush() const {
+        writer_->append(last_);
+        return {std::max<size_t>(last_.length, 1), operation_status_t::ok_k};
+    }
+    inline operation_result_t record_batch(keys_spanc_t keys, value_lengths_spanc_t sizes) const {
+        recorded_ = true;
+        if (keys.empty()) {
+            writer_->append({0, 0, 0, 0, uint32_t(operation_), 0});
+            return {0, operation_status_t::ok_k};
+        }
+        for (size_t idx = 0; idx != keys.size(); ++idx) {
+            value_length_t value_length = sizes.empty() ? 0 : sizes[idx];
+            uint32_t length = idx ? 0 : uint32_t(keys.size());
+            writer_->append({keys[idx], 0, value_length, length, uint32_t(operation_), 0});
+        }
+        return {keys.size(), operation_status_t::ok_k};
+    }
+
+    trace_writer_t* writer_;
+    operation_kind_t operation_ = operation_kind_t::read_k;
+    mutable bool recorded_ = false;
+    mutable trace_record_t last_;
+};
+
+} // namespace ucsb
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <memory>
 #include <utility>
 #include <set>
+#include <cstring>
+#include <algorithm>
 #include <fmt/format.h>
 
 #include "src/core/types.hpp"
@@ -11,6 +13,8 @@
 #include "src/core/workload.hpp"
 #include "src/core/timer.hpp"
 #include "src/core/helper.hpp"
+#include "src/core/integrity.hpp"
+#include "src/core/trace.hpp"
 #include "src/core/generators/generator.hpp"
 #include "src/core/generators/const_generator.hpp"
 #include "src/core/generators/counter_generator.hpp"
@@ -19,6 +23,10 @@
 #include "src/core/generators/scrambled_zipfian_generator.hpp"
 #include "src/core/generators/skewed_zipfian_generator.hpp"
 #include "src/core/generators/acknowledged_counter_generator.hpp"
+#include "src/core/generators/hotspot_generator.hpp"
+#include "src/core/generators/exponential_generator.hpp"
+#include "src/core/generators/normal_generator.hpp"
+#include "src/core/generators/sequential_generator.hpp"
 
 namespace ucsb {
 
@@ -36,7 +44,25 @@ class worker_t {
     using length_generator_t = std::unique_ptr<core::generator_gt<size_t>>;
     using values_and_sizes_spanc_t = std::pair<values_spanc_t, value_lengths_spanc_t>;
 
-    worker_t(workload_t const& workload, data_accessor_t& data_accessor, timer_t& timer);
+    /**
+     * @brief Suspends a logical client until its read is completed by the engine.
+     */
+    struct read_awaitable_t {
+        worker_t* worker = nullptr;
+        async_read_t* request = nullptr;
+
+        inline bool await_ready() const noexcept { return false; }
+        inline bool await_suspend(std::coroutine_handle<> handle);
+        inline operation_result_t await_resume();
+    };
+
+    /**
+     * @param trace Operations of the thread to replay, if any, so the buffers fit its largest ones.
+     */
+    worker_t(workload_t const& workload,
+             data_accessor_t& data_accessor,
+             timer_t& timer,
+             trace_stream_t const* trace = nullptr);
 
     inline operation_result_t do_upsert();
     inline operation_result_t do_update();
@@ -49,6 +75,50 @@ class worker_t {
     inline operation_result_t do_range_select();
     inline operation_result_t do_scan();
 
+    /**
+     * @brief Replays a single operation of a trace: its keys and value lengths
+     * are taken from the records, only the value bytes are generated.
+     */
+    inline operation_result_t do_traced(trace_records_spanc_t records);
+
+    /**
+     * @brief Reads into a buffer of the given logical client, so many reads can be in flight.
+     * Other operations of the clients still share the buffers and complete before returning.
+     */
+    inline read_awaitable_t do_read_async(size_t client, async_scheduler_t& scheduler);
+    inline read_awaitable_t do_read_async(size_t client, async_scheduler_t& scheduler, key_t key);
+
+    /**
+     * @brief Writes the upserts which are still waiting to be coalesced.
+     * Must be called after the last operation of the thread.
+     * If the write fails, all of its upserts are counted by `take_failed_upserts()`.
+     */
+    inline operation_result_t flush_upserts();
+    /**
+     * @brief Returns the number of coalesced upserts, whose group failed since the last call,
+     * but which weren't reported as failed by the results of their operations.
+     */
+    inline size_t take_failed_upserts();
+
+    /**
+     * @brief Starts remembering the generated keys and lengths, upserted keys included,
+     * so an aborted transaction can be retried with exactly the same ones.
+     */
+    inline void begin_transaction();
+    inline void retry_transaction();
+    /**
+     * @brief Lets readers see the keys upserted by the transaction, once it's committed or given up.
+     * Keys of a given up transaction were never written, reads of them just find nothing.
+     */
+    inline void end_transaction();
+    inline size_t generate_transaction_length();
+
+    /**
+     * @brief Returns the number of values checked in the verification mode
+     * since the last call and the number of corrupted ones among them.
+     */
+    inline std::pair<size_t, size_t> take_verification_counts();
+
   private:
     inline key_generator_t create_key_generator(workload_t const& workload,
                                                 core::counter_generator_t& counter_generator);
@@ -57,13 +127,26 @@ class worker_t {
     inline length_generator_t create_batch_read_length_generator(workload_t const& workload);
     inline length_generator_t create_bulk_load_length_generator(workload_t const& workload);
     inline length_generator_t create_range_select_length_generator(workload_t const& workload);
+    inline length_generator_t create_transaction_length_generator(workload_t const& workload);
+
+    template <typename generate_at>
+    inline size_t journaled(generate_at&& generate);
 
     inline key_t generate_key();
+    inline void acknowledge(key_t key);
     inline keys_spanc_t generate_batch_upsert_keys();
     inline keys_spanc_t generate_batch_read_keys();
     inline keys_spanc_t generate_bulk_load_keys();
-    inline value_spanc_t generate_value();
-    inline values_and_sizes_spanc_t generate_values(size_t count);
+    inline value_spanc_t generate_value(key_t key);
+    inline values_and_sizes_spanc_t generate_values(keys_spanc_t keys);
+    template <typename length_at>
+    inline values_and_sizes_spanc_t generate_values(keys_spanc_t keys, length_at&& length_of);
+    inline keys_spanc_t traced_keys(trace_records_spanc_t records);
+    inline operation_result_t coalesce_upsert(key_t key, value_spanc_t value);
+    inline operation_result_t read(key_t key, value_span_t value);
+    inline void verify_read(key_t key, value_spanc_t value);
+    inline void verify_batch_read(keys_spanc_t keys, values_spanc_t values, size_t count);
+    inline void verify_range_select(key_t key, values_spanc_t values, size_t count);
     inline value_span_t value_buffer();
     inline values_span_t values_buffer(size_t count);
 
@@ -74,7 +157,9 @@ class worker_t {
     key_generator_t upsert_key_sequence_generator;
     acknowledged_key_generator_t acknowledged_key_generator;
     key_generator_t key_generator_;
+    key_t key_shift_ = 0;
     keys_t keys_buffer_;
+    size_t value_aligned_length_ = 0;
 
     value_length_generator_t value_length_generator_;
     value_generator_t value_generator_;
@@ -85,50 +170,109 @@ class worker_t {
     length_generator_t batch_read_length_generator_;
     length_generator_t bulk_load_length_generator_;
     length_generator_t range_select_length_generator_;
+    length_generator_t transaction_length_generator_;
+
+    std::vector<size_t> journal_;
+    size_t journal_offset_ = 0;
+    bool journaling_ = false;
+    keys_t unacknowledged_keys_;
+
+    keys_t coalesced_keys_;
+    values_buffer_t coalesced_values_;
+    value_lengths_t coalesced_sizes_;
+    size_t coalesced_count_ = 0;
+    size_t coalesced_length_ = 0;
+    size_t failed_upserts_ = 0;
+
+    value_visitor_t borrowed_value_visitor_;
+    std::byte borrowed_values_digest_ = std::byte(0);
+    key_t borrowed_key_ = 0;
+
+    std::vector<async_read_t> async_reads_;
+    values_buffer_t async_values_;
+
+    keys_t sorted_keys_;
+    size_t verified_count_ = 0;
+    size_t mismatched_count_ = 0;
 };
 
-worker_t::worker_t(workload_t const& workload, data_accessor_t& data_accessor, timer_t& timer)
+worker_t::worker_t(workload_t const& workload,
+                   data_accessor_t& data_accessor,
+                   timer_t& timer,
+                   trace_stream_t const* trace)
     : workload_(workload), data_accessor_(&data_accessor), timer_(&timer) {
 
-    if (workload.upsert_proportion == 1.0 || workload.batch_upsert_proportion == 1.0 ||
-        workload.bulk_load_proportion == 1.0)
+    if (workload.verify_values && workload.value_length < sizeof(value_header_t))
+        throw exception_t(fmt::format("Value verification needs values of at least {} bytes", sizeof(value_header_t)));
+
+    if (only_inserts(workload))
         upsert_key_sequence_generator = std::make_unique<core::counter_generator_t>(workload.start_key);
     else {
-        acknowledged_key_generator =
-            std::make_unique<core::acknowledged_counter_generator_t>(workload.db_records_count);
+        acknowledged_key_generator = std::make_unique<core::acknowledged_counter_generator_t>(first_fresh_key(workload));
         key_generator_ = create_key_generator(workload, *acknowledged_key_generator);
+        if (workload.records_count)
+            key_shift_ = key_t(workload.key_shift * workload.records_count) % workload.records_count;
         upsert_key_sequence_generator = std::move(acknowledged_key_generator);
     }
     size_t elements_max_count = std::max({workload.batch_upsert_max_length,
                                           workload.batch_read_max_length,
                                           workload.bulk_load_max_length,
                                           workload.range_select_max_length,
+                                          trace ? trace->max_length : size_t(0),
                                           size_t(1)});
     keys_buffer_ = keys_t(elements_max_count);
 
     value_length_generator_ = create_value_length_generator(workload);
-    size_t value_aligned_length = roundup_to_multiple<values_buffer_t::alignment_k>(workload_.value_length);
-    values_buffer_ = values_buffer_t(elements_max_count * value_aligned_length);
+    size_t value_max_length = std::max<size_t>(workload_.value_length, trace ? trace->max_value_length : 0);
+    value_aligned_length_ = roundup_to_multiple<values_buffer_t::alignment_k>(value_max_length);
+    values_buffer_ = values_buffer_t(elements_max_count * value_aligned_length_);
     value_sizes_buffer_ = value_lengths_t(elements_max_count, 0);
 
     batch_upsert_length_generator_ = create_batch_upsert_length_generator(workload);
     batch_read_length_generator_ = create_batch_read_length_generator(workload);
     bulk_load_length_generator_ = create_bulk_load_length_generator(workload);
     range_select_length_generator_ = create_range_select_length_generator(workload);
+    if (workload.transaction_max_ops)
+        transaction_length_generator_ = create_transaction_length_generator(workload);
+
+    if (workload.upsert_coalesce_length > 1) {
+        coalesced_keys_ = keys_t(workload.upsert_coalesce_length);
+        coalesced_values_ = values_buffer_t(workload.upsert_coalesce_length * value_aligned_length_);
+        coalesced_sizes_ = value_lengths_t(workload.upsert_coalesce_length, 0);
+    }
+
+    // Note: Touch a single byte of the borrowed value, so the lookup can't be optimized away,
+    // but no copy cost is added back
+    if (workload.zero_copy_reads)
+        borrowed_value_visitor_ = [this](value_spanc_t value) {
+            if (!value.empty())
+                borrowed_values_digest_ ^= value.front();
+            if (workload_.verify_values)
+                verify_read(borrowed_key_, value);
+        };
+    if (workload.verify_values)
+        sorted_keys_ = keys_t(elements_max_count);
+
+    if (workload.queue_depth > 1) {
+        async_reads_ = std::vector<async_read_t>(workload.queue_depth);
+        async_values_ = values_buffer_t(workload.queue_depth * value_aligned_length_);
+    }
 }
 
 inline operation_result_t worker_t::do_upsert() {
-    key_t key = upsert_key_sequence_generator->generate();
-    value_spanc_t value = generate_value();
+    key_t key = journaled([&] { return upsert_key_sequence_generator->generate(); });
+    value_spanc_t value = generate_value(key);
+    if (workload_.upsert_coalesce_length > 1 && !journaling_)
+        return coalesce_upsert(key, value);
+
     auto status = data_accessor_->upsert(key, value);
-    if (acknowledged_key_generator)
-        acknowledged_key_generator->acknowledge(key);
+    acknowledge(key);
     return status;
 }
 
 inline operation_result_t worker_t::do_update() {
     key_t key = generate_key();
-    value_spanc_t value = generate_value();
+    value_spanc_t value = generate_value(key);
     return data_accessor_->update(key, value);
 }
 
@@ -140,15 +284,15 @@ inline operation_result_t worker_t::do_remove() {
 inline operation_result_t worker_t::do_read() {
     key_t key = generate_key();
     value_span_t value = value_buffer();
-    return data_accessor_->read(key, value);
+    return read(key, value);
 }
 
 inline operation_result_t worker_t::do_read_modify_write() {
     key_t key = generate_key();
     value_span_t read_value = value_buffer();
-    data_accessor_->read(key, read_value);
+    read(key, read_value);
 
-    value_spanc_t value = generate_value();
+    value_spanc_t value = generate_value(key);
     return data_accessor_->update(key, value);
 }
 
@@ -156,7 +300,7 @@ inline operation_result_t worker_t::do_batch_upsert() {
     // Note: Pause benchmark timer to do data preparation, to measure batch upsert time only
     timer_->pause();
     keys_spanc_t keys = generate_batch_upsert_keys();
-    values_and_sizes_spanc_t values_and_sizes = generate_values(keys.size());
+    values_and_sizes_spanc_t values_and_sizes = generate_values(keys);
     timer_->resume();
 
     return data_accessor_->batch_upsert(keys, values_and_sizes.first, values_and_sizes.second);
@@ -168,14 +312,17 @@ inline operation_result_t worker_t::do_batch_read() {
     keys_spanc_t keys = generate_batch_read_keys();
     values_span_t values = values_buffer(keys.size());
     timer_->resume();
-    return data_accessor_->batch_read(keys, values);
+    operation_result_t result = data_accessor_->batch_read(keys, values);
+    if (workload_.verify_values && result.status == operation_status_t::ok_k)
+        verify_batch_read(keys, values, result.entries_touched);
+    return result;
 }
 
 inline operation_result_t worker_t::do_bulk_load() {
     // Note: Pause benchmark timer to do data preparation, to measure bulk load time only
     timer_->pause();
     keys_spanc_t keys = generate_bulk_load_keys();
-    values_and_sizes_spanc_t values_and_sizes = generate_values(keys.size());
+    values_and_sizes_spanc_t values_and_sizes = generate_values(keys);
     timer_->resume();
 
     return data_accessor_->bulk_load(keys, values_and_sizes.first, values_and_sizes.second);
@@ -183,9 +330,42 @@ inline operation_result_t worker_t::do_bulk_load() {
 
 inline operation_result_t worker_t::do_range_select() {
     key_t key = generate_key();
-    size_t length = range_select_length_generator_->generate();
+    size_t length = journaled([&] { return range_select_length_generator_->generate(); });
     values_span_t values = values_buffer(length);
-    return data_accessor_->range_select(key, length, values);
+    operation_result_t result = data_accessor_->range_select(key, length, values);
+    if (workload_.verify_values && result.status == operation_status_t::ok_k)
+        verify_range_select(key, values, result.entries_touched);
+    return result;
+}
+
+inline worker_t::read_awaitable_t worker_t::do_read_async(size_t client, async_scheduler_t& scheduler) {
+    return do_read_async(client, scheduler, generate_key());
+}
+
+inline worker_t::read_awaitable_t worker_t::do_read_async(size_t client,
+                                                          async_scheduler_t& scheduler,
+                                                          key_t key) {
+    async_read_t& request = async_reads_[client];
+    request.key = key;
+    request.value = value_span_t(async_values_.data() + client * value_aligned_length_, value_aligned_length_);
+    request.result = {};
+    request.done = false;
+    request.scheduler = &scheduler;
+    return {this, &request};
+}
+
+inline bool worker_t::read_awaitable_t::await_suspend(std::coroutine_handle<> handle) {
+    worker->data_accessor_->submit_read(*request);
+    if (request->done)
+        return false;
+    request->awaiting = handle;
+    return true;
+}
+
+inline operation_result_t worker_t::read_awaitable_t::await_resume() {
+    if (worker->workload_.verify_values && request->result.status == operation_status_t::ok_k)
+        worker->verify_read(request->key, request->value);
+    return request->result;
 }
 
 inline operation_result_t worker_t::do_scan() {
@@ -193,6 +373,122 @@ inline operation_result_t worker_t::do_scan() {
     return data_accessor_->scan(workload_.start_key, workload_.records_count, single_value);
 }
 
+inline operation_result_t worker_t::do_traced(trace_records_spanc_t records) {
+    trace_record_t const& head = records.front();
+    auto traced_length = [&](size_t idx) { return records[idx].value_length; };
+
+    switch (operation_kind_t(head.operation)) {
+    case operation_kind_t::upsert_k: {
+        value_spanc_t value = generate_values(keys_spanc_t(&head.key, 1), traced_length).first;
+        if (workload_.upsert_coalesce_length > 1 && !journaling_)
+            return coalesce_upsert(head.key, value);
+        return data_accessor_->upsert(head.key, value);
+    }
+    case operation_kind_t::update_k:
+        return data_accessor_->update(head.key, generate_values(keys_spanc_t(&head.key, 1), traced_length).first);
+    case operation_kind_t::remove_k: return data_accessor_->remove(head.key);
+    case operation_kind_t::read_k: return read(head.key, value_buffer());
+    case operation_kind_t::read_modify_write_k: {
+        read(head.key, value_buffer());
+        return data_accessor_->update(head.key, generate_values(keys_spanc_t(&head.key, 1), traced_length).first);
+    }
+    case operation_kind_t::batch_upsert_k:
+    case operation_kind_t::bulk_load_k: {
+        // Note: Pause benchmark timer to do data preparation, to measure the write time only
+        timer_->pause();
+        keys_spanc_t keys = traced_keys(records);
+        values_and_sizes_spanc_t values_and_sizes = generate_values(keys, traced_length);
+        timer_->resume();
+        if (operation_kind_t(head.operation) == operation_kind_t::bulk_load_k)
+            return data_accessor_->bulk_load(keys, values_and_sizes.first, values_and_sizes.second);
+        return data_accessor_->batch_upsert(keys, values_and_sizes.first, values_and_sizes.second);
+    }
+    case operation_kind_t::batch_read_k: {
+        timer_->pause();
+        keys_spanc_t keys = traced_keys(records);
+        values_span_t values = values_buffer(keys.size());
+        timer_->resume();
+        operation_result_t result = data_accessor_->batch_read(keys, values);
+        if (workload_.verify_values && result.status == operation_status_t::ok_k)
+            verify_batch_read(keys, values, result.entries_touched);
+        return result;
+    }
+    case operation_kind_t::range_select_k: {
+        values_span_t values = values_buffer(head.length);
+        operation_result_t result = data_accessor_->range_select(head.key, head.length, values);
+        if (workload_.verify_values && result.status == operation_status_t::ok_k)
+            verify_range_select(head.key, values, result.entries_touched);
+        return result;
+    }
+    case operation_kind_t::scan_k: return data_accessor_->scan(head.key, head.length, value_buffer());
+    default: throw exception_t(fmt::format("Unknown traced operation: {}", head.operation));
+    }
+}
+
+inline operation_result_t worker_t::flush_upserts() {
+    if (!coalesced_count_)
+        return {0, operation_status_t::ok_k};
+
+    keys_spanc_t keys(coalesced_keys_.data(), coalesced_count_);
+    values_spanc_t values(coalesced_values_.data(), coalesced_length_);
+    value_lengths_spanc_t sizes(coalesced_sizes_.data(), coalesced_count_);
+    auto status = data_accessor_->batch_upsert(keys, values, sizes);
+    // Note: Keys become visible for reads only after they really reached the DB
+    if (status.status != operation_status_t::ok_k)
+        failed_upserts_ += coalesced_count_;
+    else if (acknowledged_key_generator)
+        for (key_t key : keys)
+            acknowledged_key_generator->acknowledge(key);
+
+    coalesced_count_ = 0;
+    coalesced_length_ = 0;
+    return status;
+}
+
+inline size_t worker_t::take_failed_upserts() {
+    size_t failed_upserts = failed_upserts_;
+    failed_upserts_ = 0;
+    return failed_upserts;
+}
+
+inline void worker_t::begin_transaction() {
+    journal_.clear();
+    journal_offset_ = 0;
+    journaling_ = true;
+    unacknowledged_keys_.clear();
+}
+
+inline void worker_t::retry_transaction() {
+    journal_offset_ = 0;
+    // Note: The retry upserts the same keys again, they are remembered anew
+    unacknowledged_keys_.clear();
+}
+
+inline void worker_t::end_transaction() {
+    if (acknowledged_key_generator)
+        for (key_t key : unacknowledged_keys_)
+            acknowledged_key_generator->acknowledge(key);
+    unacknowledged_keys_.clear();
+}
+
+inline void worker_t::acknowledge(key_t key) {
+    if (!acknowledged_key_generator)
+        return;
+    if (journaling_)
+        unacknowledged_keys_.push_back(key);
+    else
+        acknowledged_key_generator->acknowledge(key);
+}
+
+inline size_t worker_t::generate_transaction_length() { return transaction_length_generator_->generate(); }
+
+inline std::pair<size_t, size_t> worker_t::take_verification_counts() {
+    auto counts = std::make_pair(verified_count_, mismatched_count_);
+    verified_count_ = 0;
+    mismatched_count_ = 0;
+    return counts;
+}
+
 inline worker_t::key_generator_t worker_t::create_key_generator(workload_t const& workload,
                                                                 core::counter_generator_t& counter_generator) {
     key_generator_t generator;
@@ -212,6 +508,31 @@ inline worker_t::key_generator_t worker_t::create_key_generator(workload_t const
     case distribution_kind_t::skewed_latest_k:
         generator = std::make_unique<core::skewed_latest_generator_t>(counter_generator);
         break;
+    case distribution_kind_t::hotspot_k:
+        generator = std::make_unique<core::hotspot_generator_t>(workload.start_key,
+                                                                workload.start_key + workload.records_count - 1,
+                                                                workload.key_hot_data_fraction,
+                                                                workload.key_hot_operations_fraction);
+        break;
+    case distribution_kind_t::exponential_k:
+        generator = std::make_unique<core::exponential_generator_t>(workload.start_key,
+                                                                    workload.start_key + workload.records_count - 1,
+                                                                    workload.key_exponential_percentile,
+                                                                    workload.key_exponential_fraction);
+        break;
+    case distribution_kind_t::normal_k:
+        generator = std::make_unique<core::normal_generator_t>(workload.start_key,
+                                                               workload.start_key + workload.records_count - 1,
+                                                               workload.key_normal_center * workload.records_count,
+                                                               workload.key_normal_stddev * workload.records_count,
+                                                               workload.key_normal_drift * workload.records_count /
+                                                                   std::max<size_t>(workload.operations_count, 1));
+        break;
+    case distribution_kind_t::counter_k:
+    case distribution_kind_t::sequential_k:
+        generator = std::make_unique<core::sequential_generator_t>(workload.start_key,
+                                                                   workload.start_key + workload.records_count - 1);
+        break;
     default: throw exception_t(fmt::format("Unknown key distribution: {}", int(workload.key_dist)));
     }
     return generator;
@@ -307,29 +628,63 @@ inline worker_t::length_generator_t worker_t::create_range_select_length_generat
     return generator;
 }
 
+inline worker_t::length_generator_t worker_t::create_transaction_length_generator(workload_t const& workload) {
+
+    length_generator_t generator;
+    switch (workload.transaction_ops_dist) {
+    case distribution_kind_t::uniform_k:
+        generator = std::make_unique<core::uniform_generator_gt<size_t>>(workload.transaction_min_ops,
+                                                                         workload.transaction_max_ops);
+        break;
+    case distribution_kind_t::zipfian_k:
+        generator =
+            std::make_unique<core::zipfian_generator_t>(workload.transaction_min_ops, workload.transaction_max_ops);
+        break;
+    default:
+        throw exception_t(fmt::format("Unknown transaction length distribution: {}", int(workload.transaction_ops_dist)));
+    }
+    return generator;
+}
+
+template <typename generate_at>
+inline size_t worker_t::journaled(generate_at&& generate) {
+    if (!journaling_)
+        return generate();
+    if (journal_offset_ != journal_.size())
+        return journal_[journal_offset_++];
+
+    size_t value = generate();
+    journal_.push_back(value);
+    ++journal_offset_;
+    return value;
+}
+
 inline key_t worker_t::generate_key() {
-    key_t key = 0;
-    do {
-        key = key_generator_->generate();
-    } while (key > upsert_key_sequence_generator->last());
-    return key;
+    return journaled([&] {
+        key_t key = 0;
+        do {
+            key = key_generator_->generate();
+        } while (key > upsert_key_sequence_generator->last());
+        if (key_shift_ && key >= workload_.start_key && key - workload_.start_key < workload_.records_count)
+            key = workload_.start_key + (key - workload_.start_key + key_shift_) % workload_.records_count;
+        return key;
+    });
 }
 
 inline keys_spanc_t worker_t::generate_batch_upsert_keys() {
-    size_t batch_length = batch_upsert_length_generator_->generate();
+    size_t batch_length = journaled([&] { return batch_upsert_length_generator_->generate(); });
     keys_span_t keys(keys_buffer_.data(), batch_length);
     for (size_t i = 0; i < batch_length; ++i) {
-        key_t key = upsert_key_sequence_generator->generate();
+        key_t key = journaled([&] { return upsert_key_sequence_generator->generate(); });
         keys[i] = key;
-        if (acknowledged_key_generator)
-            acknowledged_key_generator->acknowledge(key);
+        acknowledge(key);
     }
 
     return keys;
 }
 
 inline keys_spanc_t worker_t::generate_batch_read_keys() {
-    size_t batch_length = batch_read_length_generator_->generate();
+    size_t batch_length = journaled([&] { return batch_read_length_generator_->generate(); });
     keys_span_t keys(keys_buffer_.data(), batch_length);
     size_t unique_keys_count = 0;
     std::set<key_t> unique_keys;
@@ -345,42 +700,145 @@ inline keys_spanc_t worker_t::generate_batch_read_keys() {
 }
 
 inline keys_spanc_t worker_t::generate_bulk_load_keys() {
-    size_t bulk_length = bulk_load_length_generator_->generate();
+    size_t bulk_length = journaled([&] { return bulk_load_length_generator_->generate(); });
     keys_span_t keys(keys_buffer_.data(), bulk_length);
     for (size_t i = 0; i < bulk_length; ++i) {
-        key_t key = upsert_key_sequence_generator->generate();
+        key_t key = journaled([&] { return upsert_key_sequence_generator->generate(); });
         keys[i] = key;
-        if (acknowledged_key_generator)
-            acknowledged_key_generator->acknowledge(key);
+        acknowledge(key);
     }
 
     return keys;
 }
 
-inline value_spanc_t worker_t::generate_value() {
-    values_and_sizes_spanc_t value_and_size = generate_values(1);
+inline value_spanc_t worker_t::generate_value(key_t key) {
+    values_and_sizes_spanc_t value_and_size = generate_values(keys_spanc_t(&key, 1));
     return value_spanc_t {value_and_size.first.data(), value_and_size.second.front()};
 }
 
-inline worker_t::values_and_sizes_spanc_t worker_t::generate_values(size_t count) {
-    for (size_t i = 0; i < count * workload_.value_length; ++i)
-        values_buffer_[i] = std::byte(value_generator_.generate());
+inline worker_t::values_and_sizes_spanc_t worker_t::generate_values(keys_spanc_t keys) {
+    return generate_values(keys, [&](size_t) { return value_length_generator_->generate(); });
+}
 
+template <typename length_at>
+inline worker_t::values_and_sizes_spanc_t worker_t::generate_values(keys_spanc_t keys, length_at&& length_of) {
+    size_t count = keys.size();
     size_t total_length = 0;
     for (size_t i = 0; i < count; ++i) {
-        value_length_t length = value_length_generator_->generate();
+        value_length_t length = length_of(i);
+        if (workload_.verify_values)
+            length = std::max<value_length_t>(length, sizeof(value_header_t));
         value_sizes_buffer_[i] = length;
         total_length += length;
     }
+    for (size_t i = 0; i < total_length; ++i)
+        values_buffer_[i] = std::byte(value_generator_.generate());
+
+    if (workload_.verify_values) {
+        size_t offset = 0;
+        for (size_t i = 0; i < count; ++i) {
+            stamp_value(keys[i], value_span_t(values_buffer_.data() + offset, value_sizes_buffer_[i]));
+            offset += value_sizes_buffer_[i];
+        }
+    }
     return std::make_pair(values_spanc_t(values_buffer_.data(), total_length),
                           value_lengths_spanc_t(value_sizes_buffer_.data(), count));
 }
 
+inline keys_spanc_t worker_t::traced_keys(trace_records_spanc_t records) {
+    size_t count = records.front().length;
+    keys_span_t keys(keys_buffer_.data(), count);
+    for (size_t i = 0; i < count; ++i)
+        keys[i] = records[i].key;
+    return keys;
+}
+
+inline operation_result_t worker_t::coalesce_upsert(key_t key, value_spanc_t value) {
+    coalesced_keys_[coalesced_count_] = key;
+    coalesced_sizes_[coalesced_count_] = value.size();
+    std::memcpy(coalesced_values_.data() + coalesced_length_, value.data(), value.size());
+    ++coalesced_count_;
+    coalesced_length_ += value.size();
+
+    // Note: Pending upserts touch nothing yet, all of them are accounted at once when the group is written
+    if (coalesced_count_ != workload_.upsert_coalesce_length)
+        return {0, operation_status_t::ok_k};
+    // Note: The upsert, which completes a failed group, is reported failed by its own result
+    operation_result_t result = flush_upserts();
+    failed_upserts_ -= result.status != operation_status_t::ok_k;
+    return result;
+}
+
+inline operation_result_t worker_t::read(key_t key, value_span_t value) {
+    if (workload_.zero_copy_reads) {
+        borrowed_key_ = key;
+        return data_accessor_->read_borrowed(key, value, borrowed_value_visitor_);
+    }
+
+    operation_result_t result = data_accessor_->read(key, value);
+    if (workload_.verify_values && result.status == operation_status_t::ok_k)
+        verify_read(key, value);
+    return result;
+}
+
+inline void worker_t::verify_read(key_t key, value_spanc_t value) {
+    // Note: Pause benchmark timer, so checksums don't count towards the read time
+    timer_->pause();
+    ++verified_count_;
+    mismatched_count_ += !verify_value(value, &key);
+    timer_->resume();
+}
+
+inline void worker_t::verify_batch_read(keys_spanc_t keys, values_spanc_t values, size_t count) {
+    timer_->pause();
+    // Note: Engines may return found values in any order, but always packed one after another
+    keys_span_t sorted_keys(sorted_keys_.data(), keys.size());
+    std::copy(keys.begin(), keys.end(), sorted_keys.begin());
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+
+    size_t offset = 0;
+    verified_count_ += count;
+    for (size_t idx = 0; idx != count; ++idx) {
+        value_spanc_t value = values.subspan(std::min(offset, values.size()));
+        size_t length = verify_value(value, nullptr);
+        value_header_t header;
+        if (length)
+            std::memcpy(&header, value.data(), sizeof(header));
+        if (!length || !std::binary_search(sorted_keys.begin(), sorted_keys.end(), header.key)) {
+            // Note: Without a valid header the position of the next value is unknown
+            mismatched_count_ += count - idx;
+            break;
+        }
+        offset += length;
+    }
+    timer_->resume();
+}
+
+inline void worker_t::verify_range_select(key_t key, values_spanc_t values, size_t count) {
+    timer_->pause();
+    size_t offset = 0;
+    verified_count_ += count;
+    for (size_t idx = 0; idx != count; ++idx) {
+        value_spanc_t value = values.subspan(std::min(offset, values.size()));
+        size_t length = verify_value(value, nullptr);
+        value_header_t header;
+        if (length)
+            std::memcpy(&header, value.data(), sizeof(header));
+        // Note: Selected entries must be ordered and start from the requested key
+        if (!length || header.key < key) {
+            mismatched_count_ += count - idx;
+            break;
+        }
+        key = header.key + 1;
+        offset += length;
+    }
+    timer_->resume();
+}
+
 inline value_span_t worker_t::value_buffer() { return values_buffer(1); }
 
 inline values_span_t worker_t::values_buffer(size_t count) {
-    size_t value_aligned_length = roundup_to_multiple<values_buffer_t::alignment_k>(workload_.value_length);
-    size_t total_length = count * value_aligned_length;
+    size_t total_length = count * value_aligned_length_;
     return values_span_t(values_buffer_.data(), total_length);
 }
 
@@ -4,7 +4,9 @@
 #include <string>
 #include <cstddef>
 #include <fstream>
+#include <algorithm>
 
+#include <fmt/format.h>
 #include <nlohmann/json.hpp>
 
 #include "src/core/types.hpp"
@@ -21,6 +23,11 @@ namespace ucsb {
  */
 struct workload_t {
     std::string name;
+    /**
+     * @brief Name of the workload the phase belongs to, empty for workloads without phases.
+     * Phases run back-to-back on the same open DB and are reported as "<workload>:<phase>".
+     */
+    std::string phases_name;
 
     /**
      * @brief Qualitative reference number of entries in the DB.
@@ -37,6 +44,7 @@ struct workload_t {
     /**
      * @brief Number of operations which will be done by all threads
      * Loads from workload file, doesn't change during the benchmark.
+     * Zero, if only `duration_seconds` bounds the workload.
      */
     size_t db_operations_count = 0;
     /**
@@ -45,6 +53,38 @@ struct workload_t {
      */
     size_t operations_count = 0;
 
+    /**
+     * @brief Operations done before the measured ones, to warm up caches and lazily initialized
+     * structures of the DB. They are neither timed nor counted. The warm-up of a thread lasts until
+     * it does its share of `db_warmup_operations_count` or `warmup_seconds` pass, whichever comes first.
+     * Only inserting workloads can't be bound by `warmup_seconds` alone, as their fresh keys are reserved
+     * by the operations count.
+     */
+    size_t db_warmup_operations_count = 0;
+    size_t warmup_operations_count = 0;
+    double warmup_seconds = 0;
+    /**
+     * @brief Stops the measured operations of all threads once that many seconds pass,
+     * even if they haven't done `operations_count` yet. Disabled if zero.
+     * Without `operations_count` threads run until the time is up. Only inserting workloads
+     * need the count anyway, as their fresh keys are reserved by it.
+     */
+    double duration_seconds = 0;
+
+    /**
+     * @brief Trace file to replay instead of generating the operations, see `trace.hpp`.
+     * It must have a stream per thread and then defines the operations count,
+     * the proportions and distributions are ignored.
+     */
+    fs::path trace_file_path;
+    /**
+     * @brief Open-loop replays issue every traced operation at its recorded time, divided by
+     * `replay_speedup`, instead of right after the previous one. Waiting isn't timed.
+     * Operations, which are behind the schedule, are issued at once and counted as late.
+     */
+    bool open_loop = false;
+    double replay_speedup = 1.0;
+
     float upsert_proportion = 0;
     float update_proportion = 0;
     float remove_proportion = 0;
@@ -57,7 +97,33 @@ struct workload_t {
     float scan_proportion = 0;
 
     key_t start_key = 0;
+    /**
+     * @brief Inserts don't take keys below it. Consecutive phases move it past the keys
+     * the inserting phases before them have reserved, so they don't insert the same keys again.
+     */
+    key_t fresh_start_key = 0;
+    /**
+     * @brief Rotates the generated keys by that fraction of `records_count` within the key range
+     * of every thread, so skewed distributions put their hot keys elsewhere. Keys inserted
+     * during the benchmark, out of the range, aren't shifted.
+     */
+    double key_shift = 0;
     distribution_kind_t key_dist = distribution_kind_t::uniform_k;
+    /**
+     * @brief Parameters of the key distributions, as fractions of the key range of a thread.
+     * Hotspot: `key_hot_operations_fraction` of the operations go to the first `key_hot_data_fraction` of the keys.
+     * Exponential: `key_exponential_percentile` percents of the operations go to the first
+     * `key_exponential_fraction` of the keys.
+     * Normal: `key_normal_stddev` around `key_normal_center`, which moves by `key_normal_drift`
+     * over all the operations of the thread, evenly after each of them.
+     */
+    double key_hot_data_fraction = 0.2;
+    double key_hot_operations_fraction = 0.8;
+    double key_exponential_percentile = 95;
+    double key_exponential_fraction = 0.8571428571;
+    double key_normal_center = 0.5;
+    double key_normal_stddev = 0.01;
+    double key_normal_drift = 0;
 
     value_length_t value_length = 0;
     distribution_kind_t value_length_dist = distribution_kind_t::const_k;
@@ -77,10 +143,75 @@ struct workload_t {
     size_t range_select_min_length = 0;
     size_t range_select_max_length = 0;
     distribution_kind_t range_select_length_dist = distribution_kind_t::uniform_k;
+
+    /**
+     * @brief Number of single upserts of one thread grouped into a single `batch_upsert()`.
+     * Every grouped upsert is still counted as a separate operation. Disabled if less than 2
+     * and inside transactions with explicit boundaries.
+     */
+    size_t upsert_coalesce_length = 0;
+
+    /**
+     * @brief Single reads borrow a view to the engine-owned value instead of copying it out.
+     * Only engines, which can lend their memory, skip the copy, others fall back to `read()`.
+     */
+    bool zero_copy_reads = false;
+
+    /**
+     * @brief Generated values start with their key, length and CRC32-C checksum, which are
+     * checked on every single, batch and range read outside of the timed region.
+     * Requires values of at least 16 bytes.
+     */
+    bool verify_values = false;
+
+    /**
+     * @brief Number of logical clients, coroutines, sharing a single thread.
+     * Their reads are submitted through `data_accessor_t::submit_read()`, so engines
+     * with asynchronous interfaces can keep that many requests in flight per thread.
+     * Disabled if less than 2 and with explicit transactions.
+     */
+    size_t queue_depth = 0;
+
+    /**
+     * @brief Number of operations in a single transaction of transactional benchmarks.
+     * If disabled (zero), every thread does all its operations in a single transaction.
+     */
+    size_t transaction_min_ops = 0;
+    size_t transaction_max_ops = 0;
+    distribution_kind_t transaction_ops_dist = distribution_kind_t::uniform_k;
+    /**
+     * @brief How many times an aborted transaction is retried before its operations are counted as failed.
+     */
+    size_t transaction_max_retries = 10;
 };
 
 using workloads_t = std::vector<workload_t>;
 
+inline bool only_inserts(workload_t const& workload) {
+    return workload.upsert_proportion == 1.0 || workload.batch_upsert_proportion == 1.0 ||
+           workload.bulk_load_proportion == 1.0;
+}
+
+/**
+ * @brief First key the inserts of the workload take. Workloads, which only insert, fill the keys
+ * from `start_key`, others insert after the records.
+ */
+inline key_t first_fresh_key(workload_t const& workload) {
+    key_t key = only_inserts(workload) ? workload.start_key : workload.db_records_count;
+    return std::max(key, workload.fresh_start_key);
+}
+
+/**
+ * @brief Upper bound of the keys the inserts of the workload and its warm-up take,
+ * as batches and bulk loads may be shorter and mixed workloads insert only a share of their operations.
+ */
+inline size_t reserved_keys_count(workload_t const& workload) {
+    size_t operations_count = workload.db_warmup_operations_count + workload.db_operations_count;
+    return bool(workload.upsert_proportion) * operations_count +
+           bool(workload.bulk_load_proportion) * operations_count * workload.bulk_load_max_length +
+           bool(workload.batch_upsert_proportion) * operations_count * workload.batch_upsert_max_length;
+}
+
 inline distribution_kind_t parse_distribution(std::string const& name) {
     distribution_kind_t dist = distribution_kind_t::unknown_k;
     if (name == "const")
@@ -97,9 +228,102 @@ inline distribution_kind_t parse_distribution(std::string const& name) {
         dist = distribution_kind_t::skewed_latest_k;
     else if (name == "acknowledged")
         dist = distribution_kind_t::acknowledged_counter_k;
+    else if (name == "hotspot")
+        dist = distribution_kind_t::hotspot_k;
+    else if (name == "exponential")
+        dist = distribution_kind_t::exponential_k;
+    else if (name == "normal")
+        dist = distribution_kind_t::normal_k;
+    else if (name == "sequential")
+        dist = distribution_kind_t::sequential_k;
     return dist;
 }
 
+/**
+ * @brief Reads the fields present in the JSON object, others keep their current values,
+ * so phases inherit everything they don't override from their workload.
+ */
+inline bool parse_workload(json const& j_workload, workload_t& workload) {
+
+    auto parse_dist = [&](char const* key, distribution_kind_t& dist) {
+        if (j_workload.contains(key))
+            dist = parse_distribution(j_workload[key].get<std::string>());
+        return dist != distribution_kind_t::unknown_k;
+    };
+
+    workload.db_records_count = j_workload.value("records_count", workload.db_records_count);
+    workload.db_operations_count = j_workload.value("operations_count", workload.db_operations_count);
+    workload.trace_file_path = j_workload.value("trace_path", workload.trace_file_path.string());
+    workload.open_loop = j_workload.value("open_loop", workload.open_loop);
+    workload.replay_speedup = j_workload.value("replay_speedup", workload.replay_speedup);
+    workload.db_warmup_operations_count = j_workload.value("warmup_operations", workload.db_warmup_operations_count);
+    workload.warmup_seconds = j_workload.value("warmup_seconds", workload.warmup_seconds);
+    workload.duration_seconds = j_workload.value("duration_seconds", workload.duration_seconds);
+
+    workload.upsert_proportion = j_workload.value("upsert_proportion", workload.upsert_proportion);
+    workload.update_proportion = j_workload.value("update_proportion", workload.update_proportion);
+    workload.remove_proportion = j_workload.value("remove_proportion", workload.remove_proportion);
+    workload.read_proportion = j_workload.value("read_proportion", workload.read_proportion);
+    workload.read_modify_write_proportion =
+        j_workload.value("read_modify_write_proportion", workload.read_modify_write_proportion);
+    workload.batch_upsert_proportion = j_workload.value("batch_upsert_proportion", workload.batch_upsert_proportion);
+    workload.batch_read_proportion = j_workload.value("batch_read_proportion", workload.batch_read_proportion);
+    workload.bulk_load_proportion = j_workload.value("bulk_load_proportion", workload.bulk_load_proportion);
+    workload.range_select_proportion = j_workload.value("range_select_proportion", workload.range_select_proportion);
+    workload.scan_proportion = j_workload.value("scan_proportion", workload.scan_proportion);
+
+    workload.start_key = j_workload.value("start_key", workload.start_key);
+    workload.key_shift = j_workload.value("key_shift", workload.key_shift);
+    if (!parse_dist("key_dist", workload.key_dist))
+        return false;
+    workload.key_hot_data_fraction = j_workload.value("key_hot_data_fraction", workload.key_hot_data_fraction);
+    workload.key_hot_operations_fraction =
+        j_workload.value("key_hot_operations_fraction", workload.key_hot_operations_fraction);
+    workload.key_exponential_percentile =
+        j_workload.value("key_exponential_percentile", workload.key_exponential_percentile);
+    workload.key_exponential_fraction = j_workload.value("key_exponential_fraction", workload.key_exponential_fraction);
+    workload.key_normal_center = j_workload.value("key_normal_center", workload.key_normal_center);
+    workload.key_normal_stddev = j_workload.value("key_normal_stddev", workload.key_normal_stddev);
+    workload.key_normal_drift = j_workload.value("key_normal_drift", workload.key_normal_drift);
+
+    workload.value_length = j_workload.value("value_length", workload.value_length);
+    if (!parse_dist("value_length_dist", workload.value_length_dist))
+        return false;
+
+    workload.batch_upsert_min_length = j_workload.value("batch_upsert_min_length", workload.batch_upsert_min_length);
+    workload.batch_upsert_max_length = j_workload.value("batch_upsert_max_length", workload.batch_upsert_max_length);
+    if (!parse_dist("batch_upsert_length_dist", workload.batch_upsert_length_dist))
+        return false;
+
+    workload.batch_read_min_length = j_workload.value("batch_read_min_length", workload.batch_read_min_length);
+    workload.batch_read_max_length = j_workload.value("batch_read_max_length", workload.batch_read_max_length);
+    if (!parse_dist("batch_read_length_dist", workload.batch_read_length_dist))
+        return false;
+
+    workload.bulk_load_min_length = j_workload.value("bulk_load_min_length", workload.bulk_load_min_length);
+    workload.bulk_load_max_length = j_workload.value("bulk_load_max_length", workload.bulk_load_max_length);
+    if (!parse_dist("bulk_load_length_dist", workload.bulk_load_length_dist))
+        return false;
+
+    workload.range_select_min_length = j_workload.value("range_select_min_length", workload.range_select_min_length);
+    workload.range_select_max_length = j_workload.value("range_select_max_length", workload.range_select_max_length);
+    if (!parse_dist("range_select_length_dist", workload.range_select_length_dist))
+        return false;
+
+    workload.upsert_coalesce_length = j_workload.value("upsert_coalesce_length", workload.upsert_coalesce_length);
+    workload.zero_copy_reads = j_workload.value("zero_copy_reads", workload.zero_copy_reads);
+    workload.verify_values = j_workload.value("verify_values", workload.verify_values);
+    workload.queue_depth = j_workload.value("queue_depth", workload.queue_depth);
+
+    workload.transaction_min_ops = j_workload.value("transaction_min_ops", workload.transaction_min_ops);
+    workload.transaction_max_ops = j_workload.value("transaction_max_ops", workload.transaction_max_ops);
+    if (!parse_dist("transaction_ops_dist", workload.transaction_ops_dist))
+        return false;
+    workload.transaction_max_retries = j_workload.value("transaction_max_retries", workload.transaction_max_retries);
+
+    return true;
+}
+
 bool load(fs::path const& path, workloads_t& workloads) {
 
     workloads.clear();
@@ -114,70 +338,53 @@ bool load(fs::path const& path, workloads_t& workloads) {
         workload_t workload;
 
         workload.name = (*j_workload)["name"].get<std::string>();
-
         workload.db_records_count = (*j_workload)["records_count"].get<size_t>();
-        workload.db_operations_count = (*j_workload)["operations_count"].get<size_t>();
-
-        workload.upsert_proportion = (*j_workload).value("upsert_proportion", 0.0);
-        workload.update_proportion = (*j_workload).value("update_proportion", 0.0);
-        workload.remove_proportion = (*j_workload).value("remove_proportion", 0.0);
-        workload.read_proportion = (*j_workload).value("read_proportion", 0.0);
-        workload.read_modify_write_proportion = (*j_workload).value("read_modify_write_proportion", 0.0);
-        workload.batch_upsert_proportion = (*j_workload).value("batch_upsert_proportion", 0.0);
-        workload.batch_read_proportion = (*j_workload).value("batch_read_proportion", 0.0);
-        workload.bulk_load_proportion = (*j_workload).value("bulk_load_proportion", 0.0);
-        workload.range_select_proportion = (*j_workload).value("range_select_proportion", 0.0);
-        workload.scan_proportion = (*j_workload).value("scan_proportion", 0.0);
-
-        workload.start_key = (*j_workload).value("start_key", 0);
-        workload.key_dist = parse_distribution((*j_workload).value("key_dist", "uniform"));
-        if (workload.key_dist == distribution_kind_t::unknown_k) {
-            workloads.clear();
-            return false;
-        }
-
-        workload.value_length = (*j_workload).value("value_length", 0);
-        workload.value_length_dist = parse_distribution((*j_workload).value("value_length_dist", "const"));
-        if (workload.value_length_dist == distribution_kind_t::unknown_k) {
-            workloads.clear();
-            return false;
-        }
-
-        workload.batch_upsert_min_length = (*j_workload).value("batch_upsert_min_length", 0);
-        workload.batch_upsert_max_length = (*j_workload).value("batch_upsert_max_length", 0);
-        workload.batch_upsert_length_dist =
-            parse_distribution((*j_workload).value("batch_upsert_length_dist", "uniform"));
-        if (workload.batch_upsert_length_dist == distribution_kind_t::unknown_k) {
-            workloads.clear();
-            return false;
-        }
-
-        workload.batch_read_min_length = (*j_workload).value("batch_read_min_length", 0);
-        workload.batch_read_max_length = (*j_workload).value("batch_read_max_length", 0);
-        workload.batch_read_length_dist = parse_distribution((*j_workload).value("batch_read_length_dist", "uniform"));
-        if (workload.batch_read_length_dist == distribution_kind_t::unknown_k) {
+        // Note: Traces define the operations count themselves, phases may define it on their own
+        // and workloads bound by `duration_seconds` don't need it
+        if (!j_workload->contains("trace_path") && !j_workload->contains("phases") &&
+            !j_workload->contains("duration_seconds"))
+            workload.db_operations_count = (*j_workload)["operations_count"].get<size_t>();
+        if (!parse_workload(*j_workload, workload)) {
             workloads.clear();
             return false;
         }
 
-        workload.bulk_load_min_length = (*j_workload).value("bulk_load_min_length", 0);
-        workload.bulk_load_max_length = (*j_workload).value("bulk_load_max_length", 0);
-        workload.bulk_load_length_dist = parse_distribution((*j_workload).value("bulk_load_length_dist", "uniform"));
-        if (workload.bulk_load_length_dist == distribution_kind_t::unknown_k) {
-            workloads.clear();
-            return false;
+        if (!j_workload->contains("phases")) {
+            workloads.push_back(workload);
+            continue;
         }
 
-        workload.range_select_min_length = (*j_workload).value("range_select_min_length", 0);
-        workload.range_select_max_length = (*j_workload).value("range_select_max_length", 0);
-        workload.range_select_length_dist =
-            parse_distribution((*j_workload).value("range_select_length_dist", "uniform"));
-        if (workload.key_dist == distribution_kind_t::unknown_k) {
-            workloads.clear();
-            return false;
+        // Note: Phases are consecutive workloads, every one starts from the previous phase
+        json const& j_phases = (*j_workload)["phases"];
+        std::string const name = workload.name;
+        bool unbounded_inserts = false;
+        for (size_t idx = 0; idx != j_phases.size(); ++idx) {
+            workload_t phase = workload;
+            // Note: Only the first phase warms up, unless others ask for it
+            if (idx != 0) {
+                phase.db_warmup_operations_count = 0;
+                phase.warmup_seconds = 0;
+            }
+            if (!parse_workload(j_phases[idx], phase)) {
+                workloads.clear();
+                return false;
+            }
+            phase.phases_name = name;
+            phase.name = fmt::format("{}:{}", name, j_phases[idx].value("name", std::to_string(idx + 1)));
+            workloads.push_back(phase);
+            workload = phase;
+
+            // Note: Inserts of the next phases start after the keys this one reserved,
+            // which are unknown if only `duration_seconds` bounds it, so nobody may insert after it
+            if (!phase.upsert_proportion && !phase.batch_upsert_proportion && !phase.bulk_load_proportion)
+                continue;
+            if (unbounded_inserts) {
+                workloads.clear();
+                return false;
+            }
+            unbounded_inserts = !phase.db_operations_count;
+            workload.fresh_start_key = first_fresh_key(phase) + reserved_keys_count(phase);
         }
-
-        workloads.push_back(workload);
     }
 
     return true;
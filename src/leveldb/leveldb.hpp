@@ -2,6 +2,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
 
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
@@ -17,6 +20,7 @@
 #include "src/core/types.hpp"
 #include "src/core/db.hpp"
 #include "src/core/helper.hpp"
+#include "src/core/thread_pool.hpp"
 
 namespace ucsb::google {
 
@@ -40,6 +44,14 @@ inline leveldb::Slice to_slice(value_spanc_t value) {
     return {reinterpret_cast<char const*>(value.data()), value.size()};
 }
 
+/*
+ * @brief Preallocated buffers reused between reads, as LevelDB can only read into `std::string`.
+ * Globals and especially `thread_local`s are a bad practice.
+ */
+thread_local std::string read_buffer;
+thread_local std::vector<key_t> sorted_keys;
+thread_local std::vector<std::string> chunks_values;
+
 /**
  * @brief LevelDB wrapper for the UCSB benchmark.
  * It's the precursor of RocksDB by Facebook.
@@ -47,7 +59,7 @@ inline leveldb::Slice to_slice(value_spanc_t value) {
  */
 class leveldb_t : public ucsb::db_t {
   public:
-    inline leveldb_t() : db_(nullptr) {}
+    inline leveldb_t() : db_(nullptr), batch_read_sorted_(true), batch_read_batches_in_flight_(1) {}
     ~leveldb_t() { close(); }
 
     void set_config(fs::path const& config_path,
@@ -86,9 +98,13 @@ class leveldb_t : public ucsb::db_t {
         std::string compression;
         size_t cache_size = 0;
         size_t filter_bits = -1;
+        bool batch_read_sorted = true;
+        size_t batch_read_batches_in_flight = 1;
     };
 
     inline bool load_config(config_t& config);
+    template <typename export_at>
+    inline size_t read_sorted(keys_spanc_t keys, export_at&& export_value) const;
 
     class key_comparator_t final : public leveldb::Comparator {
       public:
@@ -108,6 +124,7 @@ class leveldb_t : public ucsb::db_t {
     fs::path config_path_;
     fs::path main_dir_path_;
     std::vector<fs::path> storage_dir_paths_;
+    db_hints_t hints_;
 
     leveldb::Options options_;
     leveldb::ReadOptions read_options_;
@@ -115,15 +132,22 @@ class leveldb_t : public ucsb::db_t {
 
     std::unique_ptr<leveldb::DB> db_;
     key_comparator_t key_cmp_;
+
+    // Sorts every `batch_read` and looks it up with a forward moving iterator
+    bool batch_read_sorted_;
+    // Splits every sorted `batch_read` into this many concurrent lookups
+    size_t batch_read_batches_in_flight_;
+    std::unique_ptr<ucsb::thread_pool_t> batch_read_pool_;
 };
 
 void leveldb_t::set_config(fs::path const& config_path,
                            fs::path const& main_dir_path,
                            std::vector<fs::path> const& storage_dir_paths,
-                           [[maybe_unused]] db_hints_t const& hints) {
+                           db_hints_t const& hints) {
     config_path_ = config_path;
     main_dir_path_ = main_dir_path;
     storage_dir_paths_ = storage_dir_paths;
+    hints_ = hints;
 }
 
 bool leveldb_t::open(std::string& error) {
@@ -158,16 +182,30 @@ bool leveldb_t::open(std::string& error) {
         options_.block_cache = leveldb::NewLRUCache(config.cache_size);
     if (config.filter_bits > 0)
         options_.filter_policy = leveldb::NewBloomFilterPolicy(config.filter_bits);
+    batch_read_sorted_ = config.batch_read_sorted;
+    batch_read_batches_in_flight_ = std::max(config.batch_read_batches_in_flight, size_t(1));
 
     leveldb::DB* db_raw = nullptr;
     leveldb::Status status = leveldb::DB::Open(options_, main_dir_path_.string(), &db_raw);
     db_.reset(db_raw);
 
+    if (status.ok() && batch_read_sorted_ && batch_read_batches_in_flight_ > 1) {
+        size_t pool_size = hints_.threads_count * (batch_read_batches_in_flight_ - 1);
+        batch_read_pool_ = std::make_unique<ucsb::thread_pool_t>(pool_size);
+    }
+
     error = status.ok() ? std::string() : status.ToString();
     return status.ok();
 }
 
-void leveldb_t::close() { db_.reset(nullptr); }
+void leveldb_t::close() {
+    read_buffer.clear();
+    sorted_keys.clear();
+    chunks_values.clear();
+
+    batch_read_pool_.reset();
+    db_.reset(nullptr);
+}
 
 operation_result_t leveldb_t::upsert(key_t key, value_spanc_t value) {
     leveldb::Status status = db_->Put(write_options_, to_slice(key), to_slice(value));
@@ -176,8 +214,7 @@ operation_result_t leveldb_t::upsert(key_t key, value_spanc_t value) {
 
 operation_result_t leveldb_t::update(key_t key, value_spanc_t value) {
 
-    std::string data;
-    leveldb::Status status = db_->Get(read_options_, to_slice(key), &data);
+    leveldb::Status status = db_->Get(read_options_, to_slice(key), &read_buffer);
     if (status.IsNotFound())
         return {0, operation_status_t::not_found_k};
     else if (!status.ok())
@@ -195,15 +232,14 @@ operation_result_t leveldb_t::remove(key_t key) {
 operation_result_t leveldb_t::read(key_t key, value_span_t value) const {
 
     // Unlike RocksDB, we can't read into some form of a `PinnableSlice`,
-    // just `std::string`, causing heap allocations.
-    std::string data;
-    leveldb::Status status = db_->Get(read_options_, to_slice(key), &data);
+    // just `std::string`, so we at least reuse its capacity.
+    leveldb::Status status = db_->Get(read_options_, to_slice(key), &read_buffer);
     if (status.IsNotFound())
         return {0, operation_status_t::not_found_k};
     else if (!status.ok())
         return {0, operation_status_t::error_k};
 
-    memcpy(value.data(), data.data(), data.size());
+    memcpy(value.data(), read_buffer.data(), read_buffer.size());
     return {1, operation_status_t::ok_k};
 }
 
@@ -223,19 +259,81 @@ operation_result_t leveldb_t::batch_upsert(keys_spanc_t keys, values_spanc_t val
 
 operation_result_t leveldb_t::batch_read(keys_spanc_t keys, values_span_t values) const {
 
-    // Note: imitation of batch read!
+    // Note: LevelDB has no batch read, so the best we can do is separate `Get`s
+    if (!batch_read_sorted_) {
+        size_t offset = 0;
+        size_t found_cnt = 0;
+        for (auto key : keys) {
+            leveldb::Status status = db_->Get(read_options_, to_slice(key), &read_buffer);
+            if (status.ok()) {
+                memcpy(values.data() + offset, read_buffer.data(), read_buffer.size());
+                offset += read_buffer.size();
+                ++found_cnt;
+            }
+        }
+        return {found_cnt, operation_status_t::ok_k};
+    }
+
+    // ... or sorting the keys in the order of the DB and walking them with an iterator
+    sorted_keys.assign(keys.begin(), keys.end());
+    std::sort(sorted_keys.begin(), sorted_keys.end(), [](key_t left, key_t right) {
+        return __builtin_bswap64(left) < __builtin_bswap64(right);
+    });
+    keys_spanc_t sorted(sorted_keys.data(), sorted_keys.size());
+
     size_t offset = 0;
+    auto export_value = [&](leveldb::Slice value) {
+        memcpy(values.data() + offset, value.data(), value.size());
+        offset += value.size();
+    };
+    if (!batch_read_pool_ || keys.size() < batch_read_batches_in_flight_)
+        return {read_sorted(sorted, export_value), operation_status_t::ok_k};
+
+    // Split into contiguous key ranges, each walked by its own iterator into its own buffer.
+    // Note: The buffers are packed one after another afterwards, as the serial path does,
+    // because the lengths of the found values aren't known in advance
+    size_t chunk_length = (keys.size() + batch_read_batches_in_flight_ - 1) / batch_read_batches_in_flight_;
+    size_t chunks_count = (keys.size() + chunk_length - 1) / chunk_length;
+    if (chunks_values.size() < chunks_count)
+        chunks_values.resize(chunks_count);
+    // Note: Pool threads have their own `thread_local`s, so they get the buffers of this one explicitly
+    std::string* chunks = chunks_values.data();
+    std::atomic_size_t found_cnt = 0;
+    batch_read_pool_->parallel_for(chunks_count, [&](size_t chunk_idx) {
+        size_t begin = chunk_idx * chunk_length;
+        size_t length = std::min(chunk_length, keys.size() - begin);
+        std::string& chunk = chunks[chunk_idx];
+        chunk.clear();
+        found_cnt += read_sorted(sorted.subspan(begin, length),
+                                 [&](leveldb::Slice value) { chunk.append(value.data(), value.size()); });
+    });
+    for (size_t chunk_idx = 0; chunk_idx != chunks_count; ++chunk_idx)
+        export_value(leveldb::Slice(chunks[chunk_idx].data(), chunks[chunk_idx].size()));
+
+    return {found_cnt.load(), operation_status_t::ok_k};
+}
+
+template <typename export_at>
+inline size_t leveldb_t::read_sorted(keys_spanc_t keys, export_at&& export_value) const {
     size_t found_cnt = 0;
-    for (auto key : keys) {
-        std::string data;
-        leveldb::Status status = db_->Get(read_options_, to_slice(key), &data);
-        if (status.ok()) {
-            memcpy(values.data() + offset, data.data(), data.size());
-            offset += data.size();
-            ++found_cnt;
+    std::unique_ptr<leveldb::Iterator> it(db_->NewIterator(read_options_));
+    for (key_t key : keys) {
+        leveldb::Slice key_slice = to_slice(key);
+        // Note: If the iterator already passed the key, it isn't in the DB, otherwise seek forward
+        int order = it->Valid() ? it->key().compare(key_slice) : -1;
+        if (order < 0) {
+            it->Seek(key_slice);
+            if (!it->Valid())
+                break;
+            order = it->key().compare(key_slice);
         }
+        if (order != 0)
+            continue;
+
+        export_value(it->value());
+        ++found_cnt;
     }
-    return {found_cnt, operation_status_t::ok_k};
+    return found_cnt;
 }
 
 operation_result_t leveldb_t::bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
@@ -297,6 +395,8 @@ bool leveldb_t::load_config(config_t& config) {
     config.compression = j_config.value<std::string>("compression", "none");
     config.cache_size = j_config.value<size_t>("cache_size", size_t(134'217'728));
     config.filter_bits = j_config.value<size_t>("filter_bits", size_t(10));
+    config.batch_read_sorted = j_config.value<bool>("batch_read_sorted", true);
+    config.batch_read_batches_in_flight = j_config.value<size_t>("batch_read_batches_in_flight", size_t(1));
 
     return true;
 }
@@ -21,6 +21,7 @@ using key_t = ucsb::key_t;
 using keys_spanc_t = ucsb::keys_spanc_t;
 using value_span_t = ucsb::value_span_t;
 using value_spanc_t = ucsb::value_spanc_t;
+using value_visitor_t = ucsb::value_visitor_t;
 using values_span_t = ucsb::values_span_t;
 using values_spanc_t = ucsb::values_spanc_t;
 using value_lengths_spanc_t = ucsb::value_lengths_spanc_t;
@@ -51,6 +52,7 @@ class lmdb_t : public ucsb::db_t {
     operation_result_t update(key_t key, value_spanc_t value) override;
     operation_result_t remove(key_t key) override;
     operation_result_t read(key_t key, value_span_t value) const override;
+    operation_result_t read_borrowed(key_t key, value_span_t value, value_visitor_t const& visitor) const override;
 
     operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
     operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
@@ -279,6 +281,29 @@ operation_result_t lmdb_t::read(key_t key, value_span_t value) const {
     return {1, operation_status_t::ok_k};
 }
 
+operation_result_t lmdb_t::read_borrowed(key_t key, value_span_t, value_visitor_t const& visitor) const {
+
+    MDB_txn* txn = nullptr;
+    MDB_val key_slice, val_slice;
+
+    key_slice.mv_data = &key;
+    key_slice.mv_size = sizeof(key_t);
+
+    int res = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    if (res)
+        return {0, operation_status_t::error_k};
+    res = mdb_get(txn, dbi_, &key_slice, &val_slice);
+    if (res) {
+        mdb_txn_abort(txn);
+        return {0, operation_status_t::not_found_k};
+    }
+    // Note: The value points into the memory map and stays valid until the transaction ends
+    visitor(value_spanc_t(reinterpret_cast<std::byte const*>(val_slice.mv_data), val_slice.mv_size));
+    mdb_txn_abort(txn);
+
+    return {1, operation_status_t::ok_k};
+}
+
 operation_result_t lmdb_t::batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
 
     MDB_txn* txn = nullptr;
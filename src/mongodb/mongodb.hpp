@@ -1,9 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <optional>
+
+#include <nlohmann/json.hpp>
 #include <bsoncxx/types.hpp>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/pool.hpp>
+#include <mongocxx/write_concern.hpp>
 
 #include "src/core/types.hpp"
 #include "src/core/db.hpp"
@@ -58,6 +63,7 @@ class mongodb_t : public ucsb::db_t {
                     db_hints_t const& hints) override;
     bool open(std::string& error) override;
     void close() override;
+    void rebind_threads() override;
 
     std::string info() override;
 
@@ -81,13 +87,43 @@ class mongodb_t : public ucsb::db_t {
     std::unique_ptr<transaction_t> create_transaction() override;
 
   private:
+    struct config_t {
+        std::string uri;
+        mongocxx::write_concern write_concern;
+        bool ordered_bulk_writes = false;
+    };
+
+    /**
+     * @brief A client taken from the pool for the whole lifetime of the DB, with its collection handle.
+     */
+    struct session_t {
+        mongocxx::pool::entry client;
+        std::optional<mongocxx::collection> collection;
+    };
+
+    inline bool load_config(config_t& config);
+    /**
+     * @brief Returns the collection of the caller thread's client, acquiring it on first use.
+     * Returns `nullptr` if the pool has no client left for the thread.
+     */
+    inline mongocxx::collection* caller_collection() const;
+    inline mongocxx::bulk_write create_bulk_write(mongocxx::collection& collection) const;
+
     fs::path config_path_;
     fs::path main_dir_path_;
     std::vector<fs::path> storage_dir_paths_;
+    db_hints_t hints_;
 
     mongocxx::instance inst_;
     std::unique_ptr<mongocxx::pool> pool_;
     std::string coll_name;
+
+    mongocxx::write_concern write_concern_;
+    bool ordered_bulk_writes_ = false;
+
+    size_t state_ = 0;
+    mutable std::vector<session_t> sessions_;
+    mutable std::atomic_size_t free_sessions_count_ = 0;
 };
 
 static bsoncxx::oid make_oid(key_t key) {
@@ -116,10 +152,11 @@ static void exec_cmd(const char* cmd) {
 void mongodb_t::set_config(fs::path const& config_path,
                            fs::path const& main_dir_path,
                            std::vector<fs::path> const& storage_dir_paths,
-                           [[maybe_unused]] db_hints_t const& hints) {
+                           db_hints_t const& hints) {
     config_path_ = config_path;
     main_dir_path_ = main_dir_path;
     storage_dir_paths_ = storage_dir_paths;
+    hints_ = hints;
     coll_name = main_dir_path.parent_path().filename();
 };
 
@@ -130,63 +167,129 @@ bool mongodb_t::open(std::string& error) {
         return false;
     }
 
+    config_t config;
+    if (!load_config(config)) {
+        error = "Failed to load config";
+        return false;
+    }
+    write_concern_ = config.write_concern;
+    ordered_bulk_writes_ = config.ordered_bulk_writes;
+
     std::string start_cmd = "mongod --config ";
     start_cmd += config_path_;
     exec_cmd(start_cmd.c_str());
-    pool_ = std::make_unique<mongocxx::pool>(mongocxx::uri {"mongodb://127.0.0.1:27017/?minPoolSize=1&maxPoolSize=64"});
+    pool_ = std::make_unique<mongocxx::pool>(mongocxx::uri {config.uri});
+
+    // Note: Clients are acquired by their threads on first use, so the pool must fit all the threads,
+    // otherwise the operations of the threads left without a client fail
+    sessions_.clear();
+    sessions_.resize(hints_.threads_count);
+    rebind_threads();
     return true;
 }
 
+void mongodb_t::rebind_threads() {
+    ++state_;
+    free_sessions_count_.store(sessions_.size());
+}
+
 void mongodb_t::close() {
     batch_keys_array.clear();
     batch_keys_map.clear();
+    // Note: Clients must be returned before the pool is destroyed
+    free_sessions_count_.store(0);
+    sessions_.clear();
+    pool_.reset();
     std::string stop_cmd = "sudo mongod -f ";
     stop_cmd += config_path_;
     stop_cmd += " --shutdown";
     exec_cmd(stop_cmd.c_str());
 }
 
+inline mongocxx::collection* mongodb_t::caller_collection() const {
+    // Resolve session for the caller thread
+    thread_local size_t session_idx = 0;
+    thread_local size_t session_state = 0;
+    if (session_state != state_) [[unlikely]] {
+        auto request_idx = --free_sessions_count_;
+        if (request_idx >= sessions_.size()) {
+            // Revert
+            ++free_sessions_count_;
+            return nullptr;
+        }
+        session_idx = request_idx;
+        session_state = state_;
+    }
+
+    session_t& session = sessions_[session_idx];
+    if (!session.collection) [[unlikely]] {
+        // Note: Clients are held until the DB is closed, so waiting for one would block forever
+        auto client = (*pool_).try_acquire();
+        if (!client)
+            return nullptr;
+        session.client = std::move(*client);
+        session.collection = (*session.client)["mongodb"][coll_name];
+        session.collection->write_concern(write_concern_);
+    }
+    return &*session.collection;
+}
+
+inline mongocxx::bulk_write mongodb_t::create_bulk_write(mongocxx::collection& collection) const {
+    // Note: Unordered bulk writes let the server apply them in parallel and don't stop on the first error
+    mongocxx::options::bulk_write opts;
+    opts.ordered(ordered_bulk_writes_);
+    opts.write_concern(write_concern_);
+    return collection.create_bulk_write(opts);
+}
+
 operation_result_t mongodb_t::upsert(key_t key, value_spanc_t value) {
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
     auto bin_val = make_binary(value.data(), value.size());
     mongocxx::options::update opts;
     opts.upsert(true);
-    if (coll.update_one(make_document(kvp("_id", make_oid(key))),
-                        make_document(kvp("$set", make_document(kvp("data", bin_val)))),
-                        opts)
-            ->modified_count())
+    auto result = coll->update_one(make_document(kvp("_id", make_oid(key))),
+                                   make_document(kvp("$set", make_document(kvp("data", bin_val)))),
+                                   opts);
+    // Note: Unacknowledged writes don't return results
+    if (!result || result->matched_count() + result->upserted_count())
         return {1, operation_status_t::ok_k};
     return {0, operation_status_t::error_k};
 }
 
 operation_result_t mongodb_t::update(key_t key, value_spanc_t value) {
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
     // TODO: Do we need upsert here?
     mongocxx::options::update opts;
     opts.upsert(true);
     auto bin_val = make_binary(value.data(), value.size());
-    if (coll.update_one(make_document(kvp("_id", make_oid(key))),
-                        make_document(kvp("$set", make_document(kvp("data", bin_val)))),
-                        opts)
-            ->modified_count())
+    auto result = coll->update_one(make_document(kvp("_id", make_oid(key))),
+                                   make_document(kvp("$set", make_document(kvp("data", bin_val)))),
+                                   opts);
+    // Note: Unacknowledged writes don't return results
+    if (!result || result->matched_count() + result->upserted_count())
         return {1, operation_status_t::ok_k};
     return {0, operation_status_t::error_k};
 };
 
 operation_result_t mongodb_t::remove(key_t key) {
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
-    if (coll.delete_one(make_document(kvp("_id", make_oid(key))))->deleted_count())
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
+    auto result = coll->delete_one(make_document(kvp("_id", make_oid(key))));
+    if (!result || result->deleted_count())
         return {1, operation_status_t::ok_k};
     return {0, operation_status_t::not_found_k};
 };
 
 operation_result_t mongodb_t::read(key_t key, value_span_t value) const {
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
-    bsoncxx::stdx::optional<bsoncxx::document::value> doc = coll.find_one(make_document(kvp("_id", make_oid(key))));
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
+    bsoncxx::stdx::optional<bsoncxx::document::value> doc = coll->find_one(make_document(kvp("_id", make_oid(key))));
     if (!doc)
         return {0, operation_status_t::not_found_k};
     auto data = (*doc).view()["data"].get_binary();
@@ -195,9 +298,10 @@ operation_result_t mongodb_t::read(key_t key, value_span_t value) const {
 }
 
 operation_result_t mongodb_t::batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
-    auto bulk = mongocxx::bulk_write(coll.create_bulk_write());
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
+    auto bulk = create_bulk_write(*coll);
     size_t data_offset = 0;
     for (size_t index = 0; index < keys.size(); index++) {
         auto bin_val = make_binary(values.data() + data_offset, sizes[index]);
@@ -208,13 +312,17 @@ operation_result_t mongodb_t::batch_upsert(keys_spanc_t keys, values_spanc_t val
         bulk.append(upsert_op);
         data_offset += sizes[index];
     }
-    size_t modified_count = bulk.execute()->modified_count();
-    if (modified_count == keys.size())
+    auto result = bulk.execute();
+    if (!result || size_t(result->matched_count() + result->upserted_count()) == keys.size())
         return {keys.size(), operation_status_t::ok_k};
     return {0, operation_status_t::error_k};
 }
 
 operation_result_t mongodb_t::batch_read(keys_spanc_t keys, values_span_t values) const {
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
+
     batch_keys_map.reserve(keys.size());
 
     for (size_t index = 0; index < keys.size(); index++) {
@@ -225,9 +333,7 @@ operation_result_t mongodb_t::batch_read(keys_spanc_t keys, values_span_t values
 
     size_t found_cnt = 0;
 
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
-    auto cursor = coll.find(make_document(kvp("_id", make_document(kvp("$in", batch_keys_array)))));
+    auto cursor = coll->find(make_document(kvp("_id", make_document(kvp("$in", batch_keys_array)))));
 
     for (auto&& doc : cursor) {
         found_cnt++;
@@ -247,9 +353,10 @@ operation_result_t mongodb_t::batch_read(keys_spanc_t keys, values_span_t values
 }
 
 operation_result_t mongodb_t::bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
-    auto bulk = mongocxx::bulk_write(coll.create_bulk_write());
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
+    auto bulk = create_bulk_write(*coll);
     size_t data_offset = 0;
     for (size_t index = 0; index < keys.size(); index++) {
         auto bin_val = make_binary(values.data() + data_offset, sizes[index]);
@@ -259,19 +366,20 @@ operation_result_t mongodb_t::bulk_load(keys_spanc_t keys, values_spanc_t values
         data_offset += sizes[index];
     }
 
-    size_t inserted_count = bulk.execute()->inserted_count();
-    if (inserted_count == keys.size())
+    auto result = bulk.execute();
+    if (!result || size_t(result->inserted_count()) == keys.size())
         return {keys.size(), operation_status_t::ok_k};
     return {0, operation_status_t::error_k};
 }
 
 operation_result_t mongodb_t::range_select(key_t key, size_t length, [[maybe_unused]] values_span_t values) const {
     size_t i = 0;
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
     mongocxx::options::find opts;
     opts.limit(length);
-    auto cursor = coll.find(make_document(kvp("_id", make_document(kvp("$gt", make_oid(key))))), opts);
+    auto cursor = coll->find(make_document(kvp("_id", make_document(kvp("$gt", make_oid(key))))), opts);
 
     if (cursor.begin() == cursor.end())
         return {0, operation_status_t::error_k};
@@ -285,9 +393,10 @@ operation_result_t mongodb_t::range_select(key_t key, size_t length, [[maybe_unu
 }
 
 operation_result_t mongodb_t::scan([[maybe_unused]] key_t key, size_t length, value_span_t single_value) const {
-    auto client = (*pool_).acquire();
-    auto coll = (*client)["mongodb"][coll_name];
-    auto cursor = coll.find({});
+    auto coll = caller_collection();
+    if (!coll)
+        return {0, operation_status_t::error_k};
+    auto cursor = coll->find({});
     size_t i = 0;
     for (auto doc = cursor.begin(); doc != cursor.end() && i++ < length; doc++) {
         auto data = (*doc)["data"].get_binary();
@@ -304,4 +413,30 @@ size_t mongodb_t::size_on_disk() const { return ucsb::size_on_disk(main_dir_path
 
 std::unique_ptr<transaction_t> mongodb_t::create_transaction() { return {}; }
 
+bool mongodb_t::load_config(config_t& config) {
+    // Note: The main config belongs to `mongod`, which rejects unknown options
+    fs::path client_config_path = config_path_.parent_path();
+    client_config_path /= "additional.cfg";
+    nlohmann::json j_config = nlohmann::json::object();
+    if (fs::exists(client_config_path)) {
+        std::ifstream i_config(client_config_path);
+        i_config >> j_config;
+    }
+
+    config.uri = j_config.value<std::string>("uri", "mongodb://127.0.0.1:27017/?minPoolSize=1&maxPoolSize=64");
+    config.ordered_bulk_writes = j_config.value<bool>("ordered_bulk_writes", false);
+
+    // Note: `w` is either a number of nodes or "majority"
+    nlohmann::json j_w = j_config.value<nlohmann::json>("write_concern_w", 1);
+    if (j_w.is_string() && j_w.get<std::string>() == "majority")
+        config.write_concern.majority(std::chrono::milliseconds(0));
+    else if (j_w.is_number_integer())
+        config.write_concern.nodes(j_w.get<int32_t>());
+    else
+        return false;
+    config.write_concern.journal(j_config.value<bool>("write_concern_journal", false));
+
+    return true;
+}
+
 } // namespace ucsb::mongo
\ No newline at end of file
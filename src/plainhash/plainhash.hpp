@@ -46,6 +46,7 @@ namespace ucsb::plain
     using keys_spanc_t = ucsb::keys_spanc_t;
     using value_span_t = ucsb::value_span_t;
     using value_spanc_t = ucsb::value_spanc_t;
+    using value_t = ucsb::value_t;
     using values_span_t = ucsb::values_span_t;
     using values_spanc_t = ucsb::values_spanc_t;
     using value_lengths_spanc_t = ucsb::value_lengths_spanc_t;
@@ -58,7 +59,7 @@ namespace ucsb::plain
     class plainhash_t : public ucsb::db_t
     {
     public:
-        inline plainhash_t() : map_(std::make_unique<std::unordered_map<key_t, value_spanc_t>>()) {}
+        inline plainhash_t() : map_(std::make_unique<std::unordered_map<key_t, value_t>>()) {}
         ~plainhash_t() { plainhash_t::close(); }
 
         void set_config(fs::path const& config_path, fs::path const& main_dir_path,
@@ -89,7 +90,7 @@ namespace ucsb::plain
         std::unique_ptr<transaction_t> create_transaction() override;
 
     private:
-        std::unique_ptr<std::unordered_map<key_t, value_spanc_t>> map_;
+        std::unique_ptr<std::unordered_map<key_t, value_t>> map_;
         mutable std::mutex map_lock_;
         fs::path save_path;
     };
@@ -156,7 +157,7 @@ namespace ucsb::plain
     inline operation_result_t plainhash_t::upsert(key_t key, value_spanc_t value)
     {
         map_lock_.lock();
-        map_->insert({key, std::move(std::vector(value.begin(), value.end()))});
+        map_->insert_or_assign(key, value_t(value.begin(), value.end()));
         map_lock_.unlock();
         return {1, operation_status_t::ok_k};
     }
@@ -166,7 +167,7 @@ namespace ucsb::plain
         map_lock_.lock();
         if (map_->contains(key))
         {
-            map_->insert({key, std::move(std::vector(value.begin(), value.end()))});
+            map_->insert_or_assign(key, value_t(value.begin(), value.end()));
             map_lock_.unlock();
             return {1, operation_status_t::ok_k};
         }
@@ -198,7 +199,7 @@ namespace ucsb::plain
         map_lock_.lock();
         if (map_->contains(key))
         {
-            auto data = map_->at(key);
+            auto const& data = map_->at(key);
             memcpy(value.data(), data.data(), data.size());
             map_lock_.unlock();
             return {1, operation_status_t::ok_k};
@@ -219,7 +220,7 @@ namespace ucsb::plain
         {
             key_t key = keys[idx];
             auto value = values.subspan(offset, sizes[idx]);
-            map_->insert({key, std::move(std::vector(value.begin(), value.end()))});
+            map_->insert_or_assign(key, value_t(value.begin(), value.end()));
             offset += sizes[idx];
         }
         map_lock_.unlock();
@@ -233,7 +234,7 @@ namespace ucsb::plain
         size_t offset = 0;
         for (auto key : keys)
         {
-            auto data = map_->at(key);
+            auto const& data = map_->at(key);
             memcpy(values.data() + offset, data.data(), data.size());
             offset += data.size();
         }
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
+#include <optional>
 
+#include <fmt/format.h>
 #include <nlohmann/json.hpp>
 #include <sw/redis++/redis++.h>
 
@@ -26,20 +30,53 @@ using operation_status_t = ucsb::operation_status_t;
 using operation_result_t = ucsb::operation_result_t;
 using db_hints_t = ucsb::db_hints_t;
 using transaction_t = ucsb::transaction_t;
+using async_read_t = ucsb::async_read_t;
+
+/**
+ * @brief How the benchmark keys are mapped onto the Redis keyspace.
+ */
+enum class key_layout_t {
+    hash_k,           // Fields of a single hash
+    sharded_hashes_k, // Fields of `hashes_count` hashes
+    strings_k,        // Plain string keys
+};
+
+constexpr size_t cluster_slots_count_k = 16384;
+
+/*
+ * @brief Preallocated buffers used for batch operations.
+ * Globals and especially `thread_local`s are a bad practice.
+ */
+thread_local std::vector<sw::redis::StringView> batch_args;
+thread_local std::vector<size_t> batch_groups;
+thread_local std::vector<size_t> batch_group_offsets;
+thread_local std::vector<size_t> batch_group_ends;
+thread_local std::vector<size_t> batch_order;
+thread_local std::vector<size_t> batch_value_offsets;
+thread_local std::vector<redisReply const*> batch_replies;
+thread_local std::vector<sw::redis::QueuedReplies> batch_queued_replies;
 
 /**
  * @brief Redis wrapper for the UCSB benchmark.
  * Using redis-plus-plus client, based on hiredis.
  * https://github.com/sewenew/redis-plus-plus
+ *
+ * Keys can be spread over several local instances, routed by
+ * their Redis Cluster hash slots without the cluster bus.
  */
 
 struct redis_t : public ucsb::db_t {
   public:
     ~redis_t() {
-        std::string stop_cmd = "redis-cli -s ";
-        stop_cmd += connection_options_.path;
-        stop_cmd += " shutdown";
-        exec_cmd(stop_cmd.c_str());
+        for (auto const& options : instance_options_) {
+            std::string stop_cmd = "redis-cli ";
+            if (options.type == sw::redis::ConnectionType::UNIX)
+                stop_cmd += fmt::format("-s {}", options.path);
+            else
+                stop_cmd += fmt::format("-h {} -p {}", options.host, options.port);
+            stop_cmd += " shutdown";
+            exec_cmd(stop_cmd.c_str());
+        }
     }
     void set_config(fs::path const& config_path,
                     fs::path const& main_dir_path,
@@ -47,6 +84,7 @@ struct redis_t : public ucsb::db_t {
                     db_hints_t const& hints) override;
     bool open(std::string& error) override;
     void close() override;
+    void rebind_threads() override;
 
     std::string info() override;
 
@@ -55,6 +93,9 @@ struct redis_t : public ucsb::db_t {
     operation_result_t remove(key_t key) override;
     operation_result_t read(key_t key, value_span_t value) const override;
 
+    void submit_read(async_read_t& request) const override;
+    void poll_completions() const override;
+
     operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
     operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
 
@@ -69,18 +110,92 @@ struct redis_t : public ucsb::db_t {
 
     std::unique_ptr<transaction_t> create_transaction() override;
 
-    void get_options(fs::path const& path);
+    bool get_options(fs::path const& path);
     std::string exec_cmd(const char* cmd);
 
   private:
+    /**
+     * @brief A dedicated connection of a single worker with commands queued on it.
+     */
+    struct pipeline_t {
+        std::unique_ptr<sw::redis::Pipeline> pipe;
+        size_t queued = 0;
+        // Submitted reads with the positions of their replies
+        std::vector<std::pair<size_t, async_read_t*>> reads;
+    };
+
+    /**
+     * @brief Returns the pipeline of the caller thread to the given instance
+     * or `nullptr` if pipelining is disabled.
+     */
+    inline pipeline_t* caller_pipeline(size_t instance) const;
+    inline void open_pipelines();
+    /**
+     * @brief Sends all the queued commands in a single round trip
+     * and completes the submitted reads among them.
+     * Fails if any of them failed.
+     */
+    inline std::optional<sw::redis::QueuedReplies> execute(sw::redis::Pipeline& pipe) const;
+    inline std::optional<sw::redis::QueuedReplies> execute(pipeline_t& pipeline) const;
+    /**
+     * @brief Sends the command in `batch_args` on its own, bypassing pipelines.
+     * Returns `nullptr` if it failed.
+     */
+    inline sw::redis::ReplyUPtr command(size_t instance) const;
+    /**
+     * @brief Counts queued writes and sends the pipeline once it's deep enough.
+     * Note: Writes are acknowledged when queued, so their errors fail the operation that sends them.
+     */
+    inline bool enqueue(pipeline_t& pipeline, size_t commands_count) const;
+
+    /**
+     * @brief Maps a Redis key into its instance, the way Redis Cluster assigns
+     * contiguous ranges of hash slots to nodes. Hash tags aren't supported.
+     */
+    inline size_t instance_of(sw::redis::StringView redis_key) const;
+    /**
+     * @brief Returns the Redis key holding the given benchmark key.
+     */
+    inline sw::redis::StringView redis_key_of(key_t const& key) const;
+    /**
+     * @brief Groups are the units of batching: hashes or, for plain keys, instances.
+     */
+    inline size_t group_of(key_t const& key) const;
+    /**
+     * @brief Orders keys by their groups into `batch_order` and `batch_group_offsets`.
+     */
+    inline void group_keys(keys_spanc_t keys) const;
+    /**
+     * @brief Puts a group command into `batch_args`, with values if given.
+     */
+    inline void group_command(size_t group,
+                              keys_spanc_t keys,
+                              values_spanc_t values,
+                              value_lengths_spanc_t sizes,
+                              char const* hash_command,
+                              char const* strings_command) const;
+
     fs::path config_path_;
     fs::path main_dir_path_;
     std::vector<fs::path> storage_dir_paths_;
+    db_hints_t hints_;
 
-    std::unique_ptr<sw::redis::Redis> redis_;
+    std::vector<std::unique_ptr<sw::redis::Redis>> instances_;
+    std::vector<sw::redis::ConnectionOptions> instance_options_;
     sw::redis::ConnectionOptions connection_options_;
     sw::redis::ConnectionPoolOptions connection_pool_options_;
     bool is_opened_ = false;
+
+    key_layout_t key_layout_ = key_layout_t::hash_k;
+    size_t instances_count_ = 1;
+    std::vector<std::string> hash_names_;
+    std::vector<size_t> group_instances_;
+
+    // Commands in flight per worker, pipelining is disabled if it's less than 2
+    size_t pipeline_depth_ = 0;
+    size_t state_ = 0;
+    mutable std::vector<pipeline_t> pipelines_;
+    mutable std::atomic_size_t free_pipelines_count_ = 0;
 };
 
 inline sw::redis::StringView to_string_view(std::byte const* p, size_t size_bytes) noexcept {
@@ -91,6 +206,29 @@ inline sw::redis::StringView to_string_view(key_t const& k) noexcept {
     return {reinterpret_cast<const char*>(&k), sizeof(key_t)};
 }
 
+/**
+ * @brief CRC16-CCITT (XMODEM), which Redis Cluster uses to compute hash slots.
+ */
+inline uint16_t crc16(char const* data, size_t length) noexcept {
+    uint16_t crc = 0;
+    for (size_t i = 0; i != length; ++i) {
+        crc ^= uint16_t(uint8_t(data[i])) << 8;
+        for (size_t bit = 0; bit != 8; ++bit)
+            crc = crc & 0x8000 ? uint16_t(crc << 1) ^ 0x1021 : uint16_t(crc << 1);
+    }
+    return crc;
+}
+
+/**
+ * @brief Copies the payload of a bulk string reply straight into `value`.
+ */
+inline bool export_value(redisReply const& reply, std::byte* value) noexcept {
+    if (reply.type != REDIS_REPLY_STRING)
+        return false;
+    memcpy(value, reply.str, reply.len);
+    return true;
+}
+
 std::string redis_t::exec_cmd(const char* cmd) {
     using namespace std::chrono_literals;
     std::array<char, 4096> buffer;
@@ -106,7 +244,7 @@ std::string redis_t::exec_cmd(const char* cmd) {
     return result;
 }
 
-void redis_t::get_options(fs::path const& path) {
+bool redis_t::get_options(fs::path const& path) {
     std::ifstream cfg_file(path);
     nlohmann::json j_config;
     cfg_file >> j_config;
@@ -121,152 +259,450 @@ void redis_t::get_options(fs::path const& path) {
     }
     connection_pool_options_.wait_timeout = std::chrono::milliseconds(j_config["wait_timeout"].get<int>());
     connection_pool_options_.size = j_config["pool_size"].get<int>();
+    pipeline_depth_ = j_config.value<size_t>("pipeline_depth", 0);
+
+    std::string key_layout = j_config.value<std::string>("key_layout", "hash");
+    if (key_layout == "hash")
+        key_layout_ = key_layout_t::hash_k;
+    else if (key_layout == "sharded_hashes")
+        key_layout_ = key_layout_t::sharded_hashes_k;
+    else if (key_layout == "strings")
+        key_layout_ = key_layout_t::strings_k;
+    else
+        return false;
+
+    size_t hashes_count = key_layout_ == key_layout_t::sharded_hashes_k ? j_config.value<size_t>("hashes_count", 16) : 1;
+    instances_count_ = j_config.value<size_t>("instances_count", 1);
+    if (!hashes_count || !instances_count_ || instances_count_ > cluster_slots_count_k)
+        return false;
+
+    hash_names_.clear();
+    if (key_layout_ == key_layout_t::sharded_hashes_k)
+        for (size_t i = 0; i != hashes_count; ++i)
+            hash_names_.push_back(fmt::format("hash:{}", i));
+    else if (key_layout_ == key_layout_t::hash_k)
+        hash_names_.push_back("hash");
+
+    return true;
 }
 
 void redis_t::set_config(fs::path const& config_path,
                          fs::path const& main_dir_path,
                          std::vector<fs::path> const& storage_dir_paths,
-                         [[maybe_unused]] db_hints_t const& hints) {
+                         db_hints_t const& hints) {
     config_path_ = config_path;
     main_dir_path_ = main_dir_path;
     storage_dir_paths_ = storage_dir_paths;
+    hints_ = hints;
 }
 
 bool redis_t::open(std::string& error) {
-    if (is_opened_)
+    // Note: Servers keep running between workloads, only the pipelines dropped by `close` are reopened
+    if (is_opened_) {
+        open_pipelines();
         return true;
+    }
 
     if (!storage_dir_paths_.empty()) {
         error = "Doesn't support multiple disks";
         return false;
     }
 
-    std::string start_cmd("redis-server ");
-    start_cmd += config_path_;
-    start_cmd += ".redis";
-    exec_cmd(start_cmd.c_str());
+    if (!get_options(config_path_)) {
+        error = "Invalid key layout";
+        return false;
+    }
+
+    // Note: A single instance keeps the ports, sockets and files of the `.redis` config
+    instance_options_.clear();
+    for (size_t i = 0; i != instances_count_; ++i) {
+        std::string start_cmd("redis-server ");
+        start_cmd += config_path_;
+        start_cmd += ".redis";
+
+        sw::redis::ConnectionOptions options = connection_options_;
+        if (instances_count_ > 1) {
+            options.port += int(i);
+            fs::path socket_path = options.path;
+            if (!socket_path.empty())
+                options.path = socket_path.replace_filename(fmt::format("redis_{}.sock", i)).string();
+            start_cmd += fmt::format(
+                " --port {} --unixsocket redis_{}.sock --pidfile redis_{}.pid --logfile redis_{}.log --dbfilename dump_{}.rdb",
+                connection_options_.port + int(i),
+                i,
+                i,
+                i,
+                i);
+        }
+        exec_cmd(start_cmd.c_str());
+        instance_options_.push_back(options);
+    }
+
+    instances_.clear();
+    for (auto const& options : instance_options_)
+        instances_.push_back(std::make_unique<sw::redis::Redis>(options, connection_pool_options_));
+
+    group_instances_.clear();
+    if (key_layout_ == key_layout_t::strings_k)
+        for (size_t i = 0; i != instances_count_; ++i)
+            group_instances_.push_back(i);
+    else
+        for (auto const& hash_name : hash_names_)
+            group_instances_.push_back(instance_of(hash_name));
 
-    get_options(config_path_);
-    redis_ = std::make_unique<sw::redis::Redis>(sw::redis::Redis(connection_options_, connection_pool_options_));
+    open_pipelines();
     is_opened_ = true;
     return true;
 }
 
-void redis_t::close() {}
+inline void redis_t::open_pipelines() {
+    // Note: Pipelines are opened by their workers on first use
+    pipelines_.clear();
+    if (pipeline_depth_ > 1)
+        pipelines_.resize(hints_.threads_count * instances_count_);
+    rebind_threads();
+}
 
-operation_result_t redis_t::upsert(key_t key, value_spanc_t value) {
-    auto status = (*redis_).hset("hash", to_string_view(key), to_string_view(value.data(), value.size()));
-    return {size_t(status), status ? operation_status_t::ok_k : operation_status_t::error_k};
+void redis_t::rebind_threads() {
+    ++state_;
+    free_pipelines_count_.store(hints_.threads_count);
+}
+
+void redis_t::close() {
+    flush();
+    free_pipelines_count_.store(0);
+    pipelines_.clear();
+}
+
+inline redis_t::pipeline_t* redis_t::caller_pipeline(size_t instance) const {
+    if (pipelines_.empty())
+        return nullptr;
+
+    // Resolve pipelines for the caller thread
+    thread_local size_t pipelines_idx = 0;
+    thread_local size_t pipelines_state = 0;
+    if (pipelines_state != state_) [[unlikely]] {
+        auto request_idx = --free_pipelines_count_;
+        if (request_idx >= hints_.threads_count) {
+            // Revert
+            ++free_pipelines_count_;
+            return nullptr;
+        }
+        pipelines_idx = request_idx;
+        pipelines_state = state_;
+    }
+
+    pipeline_t& pipeline = pipelines_[pipelines_idx * instances_count_ + instance];
+    if (!pipeline.pipe) [[unlikely]]
+        pipeline.pipe = std::make_unique<sw::redis::Pipeline>((*instances_[instance]).pipeline());
+    return &pipeline;
+}
+
+inline std::optional<sw::redis::QueuedReplies> redis_t::execute(sw::redis::Pipeline& pipe) const {
+    try {
+        auto replies = pipe.exec();
+        for (size_t i = 0; i != replies.size(); ++i)
+            if (replies.get(i).type == REDIS_REPLY_ERROR)
+                return std::nullopt;
+        return replies;
+    }
+    catch (sw::redis::Error const&) {
+        return std::nullopt;
+    }
+}
+
+inline std::optional<sw::redis::QueuedReplies> redis_t::execute(pipeline_t& pipeline) const {
+    pipeline.queued = 0;
+    auto replies = execute(*pipeline.pipe);
+    for (auto [reply_idx, request] : pipeline.reads) {
+        if (!replies)
+            request->complete({0, operation_status_t::error_k});
+        else if (!export_value(replies->get(reply_idx), request->value.data()))
+            request->complete({0, operation_status_t::not_found_k});
+        else
+            request->complete({1, operation_status_t::ok_k});
+    }
+    pipeline.reads.clear();
+
+    // Note: A broken pipeline can't be reused, so it's reopened on next use
+    if (!replies)
+        pipeline.pipe.reset();
+    return replies;
+}
+
+inline sw::redis::ReplyUPtr redis_t::command(size_t instance) const {
+    try {
+        auto reply = (*instances_[instance]).command(batch_args.begin(), batch_args.end());
+        if (reply && reply->type == REDIS_REPLY_ERROR)
+            return nullptr;
+        return reply;
+    }
+    catch (sw::redis::Error const&) {
+        return nullptr;
+    }
+}
+
+inline bool redis_t::enqueue(pipeline_t& pipeline, size_t commands_count) const {
+    pipeline.queued += commands_count;
+    if (pipeline.queued < pipeline_depth_)
+        return true;
+    return execute(pipeline).has_value();
+}
+
+inline size_t redis_t::instance_of(sw::redis::StringView redis_key) const {
+    if (instances_count_ == 1)
+        return 0;
+    size_t slot = crc16(redis_key.data(), redis_key.size()) % cluster_slots_count_k;
+    return slot * instances_count_ / cluster_slots_count_k;
+}
+
+inline sw::redis::StringView redis_t::redis_key_of(key_t const& key) const {
+    if (key_layout_ == key_layout_t::strings_k)
+        return to_string_view(key);
+    return hash_names_[key % hash_names_.size()];
+}
+
+inline size_t redis_t::group_of(key_t const& key) const {
+    if (key_layout_ == key_layout_t::strings_k)
+        return instance_of(to_string_view(key));
+    return key % hash_names_.size();
 }
 
-operation_result_t redis_t::update(key_t key, value_spanc_t value) {
-    auto status = (*redis_).hset("hash", to_string_view(key), to_string_view(value.data(), value.size()));
-    return {status, status ? operation_status_t::ok_k : operation_status_t::not_found_k};
+inline void redis_t::group_keys(keys_spanc_t keys) const {
+    // Note: A counting sort, which keeps the order of keys within every group
+    batch_groups.resize(keys.size());
+    batch_group_offsets.assign(group_instances_.size() + 1, 0);
+    for (size_t idx = 0; idx != keys.size(); ++idx) {
+        batch_groups[idx] = group_of(keys[idx]);
+        ++batch_group_offsets[batch_groups[idx] + 1];
+    }
+    for (size_t group = 0; group != group_instances_.size(); ++group)
+        batch_group_offsets[group + 1] += batch_group_offsets[group];
+
+    batch_order.resize(keys.size());
+    batch_group_ends.assign(batch_group_offsets.begin(), batch_group_offsets.end() - 1);
+    for (size_t idx = 0; idx != keys.size(); ++idx)
+        batch_order[batch_group_ends[batch_groups[idx]]++] = idx;
+}
+
+inline void redis_t::group_command(size_t group,
+                                   keys_spanc_t keys,
+                                   values_spanc_t values,
+                                   value_lengths_spanc_t sizes,
+                                   char const* hash_command,
+                                   char const* strings_command) const {
+    batch_args.clear();
+    if (key_layout_ == key_layout_t::strings_k)
+        batch_args.push_back(strings_command);
+    else {
+        batch_args.push_back(hash_command);
+        batch_args.push_back(hash_names_[group]);
+    }
+    for (size_t i = batch_group_offsets[group]; i != batch_group_offsets[group + 1]; ++i) {
+        size_t idx = batch_order[i];
+        batch_args.push_back(to_string_view(keys[idx]));
+        if (!values.empty())
+            batch_args.push_back(to_string_view(values.data() + batch_value_offsets[idx], sizes[idx]));
+    }
+}
+
+// Note: `HSET` returns the number of new fields, so overwriting an existing one isn't a failure
+operation_result_t redis_t::upsert(key_t key, value_spanc_t value) {
+    auto redis_key = redis_key_of(key);
+    size_t instance = instance_of(redis_key);
+    batch_args.clear();
+    if (key_layout_ == key_layout_t::strings_k)
+        batch_args.insert(batch_args.end(), {"SET", redis_key});
+    else
+        batch_args.insert(batch_args.end(), {"HSET", redis_key, to_string_view(key)});
+    batch_args.push_back(to_string_view(value.data(), value.size()));
+
+    if (pipeline_t* pipeline = caller_pipeline(instance)) {
+        pipeline->pipe->command(batch_args.begin(), batch_args.end());
+        bool ok = enqueue(*pipeline, 1);
+        return {size_t(ok), ok ? operation_status_t::ok_k : operation_status_t::error_k};
+    }
+
+    auto reply = command(instance);
+    return {size_t(bool(reply)), reply ? operation_status_t::ok_k : operation_status_t::error_k};
 }
 
+operation_result_t redis_t::update(key_t key, value_spanc_t value) { return upsert(key, value); }
+
 operation_result_t redis_t::remove(key_t key) {
-    size_t count = (*redis_).hdel("hash", to_string_view(key));
+    auto redis_key = redis_key_of(key);
+    size_t instance = instance_of(redis_key);
+    batch_args.clear();
+    if (key_layout_ == key_layout_t::strings_k)
+        batch_args.insert(batch_args.end(), {"DEL", redis_key});
+    else
+        batch_args.insert(batch_args.end(), {"HDEL", redis_key, to_string_view(key)});
+
+    if (pipeline_t* pipeline = caller_pipeline(instance)) {
+        pipeline->pipe->command(batch_args.begin(), batch_args.end());
+        bool ok = enqueue(*pipeline, 1);
+        return {size_t(ok), ok ? operation_status_t::ok_k : operation_status_t::error_k};
+    }
+
+    auto reply = command(instance);
+    if (!reply)
+        return {0, operation_status_t::error_k};
+    size_t count = reply->type == REDIS_REPLY_INTEGER ? size_t(reply->integer) : 0;
     return {count, count ? operation_status_t::ok_k : operation_status_t::not_found_k};
 }
 
 operation_result_t redis_t::read(key_t key, value_span_t value) const {
-    auto val = (*redis_).hget("hash", to_string_view(key));
-    if (!val)
-        return {0, operation_status_t::not_found_k};
+    auto redis_key = redis_key_of(key);
+    size_t instance = instance_of(redis_key);
+    batch_args.clear();
+    if (key_layout_ == key_layout_t::strings_k)
+        batch_args.insert(batch_args.end(), {"GET", redis_key});
+    else
+        batch_args.insert(batch_args.end(), {"HGET", redis_key, to_string_view(key)});
+
+    // Note: Raw replies are used to skip copying the payload into an intermediate `std::string`
+    if (pipeline_t* pipeline = caller_pipeline(instance)) {
+        // Queued writes are sent in the same round trip
+        pipeline->pipe->command(batch_args.begin(), batch_args.end());
+        auto replies = execute(*pipeline);
+        if (!replies)
+            return {0, operation_status_t::error_k};
+        if (!export_value(replies->get(replies->size() - 1), value.data()))
+            return {0, operation_status_t::not_found_k};
+        return {1, operation_status_t::ok_k};
+    }
 
-    memcpy(value.data(), &val, sizeof(val));
+    auto reply = command(instance);
+    if (!reply)
+        return {0, operation_status_t::error_k};
+    if (!export_value(*reply, value.data()))
+        return {0, operation_status_t::not_found_k};
     return {1, operation_status_t::ok_k};
 }
 
-operation_result_t redis_t::batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
-    struct kv_iterator_t {
-        using pair_t = std::pair<sw::redis::StringView, sw::redis::StringView>;
-        using val_t = typename values_spanc_t::element_type;
-        key_t const* key_ptr_;
-        val_t* val_ptr_;
-        value_length_t const* size_ptr_;
-        pair_t pair_;
-
-        kv_iterator_t(key_t const* key_ptr, val_t const* val_ptr, value_length_t const* size_ptr) noexcept
-            : key_ptr_(key_ptr), val_ptr_(val_ptr), size_ptr_(size_ptr),
-              pair_(std::make_pair(to_string_view(*key_ptr_), to_string_view(val_ptr_, *size_ptr_))) {}
-
-        pair_t const& operator*() const noexcept { return pair_; }
-        pair_t const* operator->() const noexcept { return &pair_; }
-        bool operator==(kv_iterator_t const& other) const noexcept { return key_ptr_ == other.key_ptr_; }
-
-        kv_iterator_t& operator++() noexcept {
-            key_ptr_++;
-            val_ptr_ += *size_ptr_;
-            size_ptr_++;
-            pair_.first = to_string_view(*key_ptr_);
-            pair_.second = to_string_view(val_ptr_, *size_ptr_);
-            return *this;
-        }
-    };
+void redis_t::submit_read(async_read_t& request) const {
+    auto redis_key = redis_key_of(request.key);
+    size_t instance = instance_of(redis_key);
+    pipeline_t* pipeline = caller_pipeline(instance);
+    if (!pipeline) {
+        request.complete(read(request.key, request.value));
+        return;
+    }
 
-    (*redis_).hmset(
-        "hash",
-        kv_iterator_t(keys.data(), values.data(), sizes.data()),
-        kv_iterator_t(keys.data() + keys.size(), values.data() + values.size(), sizes.data() + sizes.size()));
-    return {keys.size(), operation_status_t::ok_k};
+    batch_args.clear();
+    if (key_layout_ == key_layout_t::strings_k)
+        batch_args.insert(batch_args.end(), {"GET", redis_key});
+    else
+        batch_args.insert(batch_args.end(), {"HGET", redis_key, to_string_view(request.key)});
+
+    // Note: Reads wait for replies only when the pipeline is sent, by depth or by polling
+    pipeline->pipe->command(batch_args.begin(), batch_args.end());
+    pipeline->reads.emplace_back(pipeline->queued, &request);
+    enqueue(*pipeline, 1);
 }
 
-operation_result_t redis_t::batch_read(keys_spanc_t keys, values_span_t values) const {
-    struct key_iterator_t {
-        key_t const* key_ptr_;
+void redis_t::poll_completions() const {
+    for (size_t instance = 0; instance != instances_count_; ++instance) {
+        pipeline_t* pipeline = caller_pipeline(instance);
+        if (pipeline && !pipeline->reads.empty())
+            execute(*pipeline);
+    }
+}
 
-        key_iterator_t(key_t const* key_ptr) noexcept : key_ptr_(key_ptr) {}
-        sw::redis::StringView operator*() const noexcept { return to_string_view(*key_ptr_); }
-        bool operator==(key_iterator_t const& other) const noexcept { return key_ptr_ == other.key_ptr_; }
+operation_result_t redis_t::batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
+    group_keys(keys);
+    batch_value_offsets.resize(keys.size());
+    size_t offset = 0;
+    for (size_t idx = 0; idx != keys.size(); ++idx) {
+        batch_value_offsets[idx] = offset;
+        offset += sizes[idx];
+    }
 
-        key_iterator_t& operator++() noexcept {
-            key_ptr_++;
-            return *this;
+    // Note: Every instance gets all its group commands in a single round trip
+    size_t upserted = 0;
+    for (size_t instance = 0; instance != instances_count_; ++instance) {
+        pipeline_t* pipeline = caller_pipeline(instance);
+        std::optional<sw::redis::Pipeline> transient;
+        sw::redis::Pipeline& pipe = pipeline ? *pipeline->pipe : transient.emplace((*instances_[instance]).pipeline(false));
+
+        size_t commands_count = 0;
+        size_t keys_count = 0;
+        for (size_t group = 0; group != group_instances_.size(); ++group) {
+            if (group_instances_[group] != instance || batch_group_offsets[group] == batch_group_offsets[group + 1])
+                continue;
+            group_command(group, keys, values, sizes, "HSET", "MSET");
+            pipe.command(batch_args.begin(), batch_args.end());
+            ++commands_count;
+            keys_count += batch_group_offsets[group + 1] - batch_group_offsets[group];
         }
-    };
+        if (!commands_count)
+            continue;
 
-    struct value_getter_t {
-        using value_type = sw::redis::Optional<std::string>;
-        using iterator = values_span_t::pointer;
-
-        values_span_t values;
-        size_t count = 0;
-        size_t offset = 0;
-
-        iterator push_back(value_type value) noexcept {
-            if (!value)
-                return values.data() + offset;
-            memcpy(values.data() + offset, &value, sizeof(value));
-            offset += sizeof(value);
-            count++;
-            return values.data() + offset;
-        }
-    };
+        bool ok = pipeline ? enqueue(*pipeline, commands_count) : execute(pipe).has_value();
+        upserted += ok * keys_count;
+    }
 
-    value_getter_t getter(values);
-    (*redis_).hmget("hash",
-                    key_iterator_t(keys.data()),
-                    key_iterator_t(keys.data() + keys.size()),
-                    std::back_inserter(getter));
-    return {getter.count, getter.count ? operation_status_t::ok_k : operation_status_t::error_k};
+    return {upserted, upserted == keys.size() ? operation_status_t::ok_k : operation_status_t::error_k};
 }
 
-operation_result_t redis_t::bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
-    auto data_offset = 0;
-    auto pipe = (*redis_).pipeline(false);
-    for (size_t i = 0; i != keys.size(); ++i) {
-        pipe.hset("hash", to_string_view(keys[i]), to_string_view(values.data() + data_offset, sizes[i]));
-        data_offset += sizes[i];
+operation_result_t redis_t::batch_read(keys_spanc_t keys, values_span_t values) const {
+    group_keys(keys);
+    batch_replies.assign(keys.size(), nullptr);
+    batch_queued_replies.clear();
+
+    // Note: Every instance gets all its group commands in a single round trip
+    for (size_t instance = 0; instance != instances_count_; ++instance) {
+        pipeline_t* pipeline = caller_pipeline(instance);
+        std::optional<sw::redis::Pipeline> transient;
+        sw::redis::Pipeline& pipe = pipeline ? *pipeline->pipe : transient.emplace((*instances_[instance]).pipeline(false));
+
+        size_t commands_count = 0;
+        for (size_t group = 0; group != group_instances_.size(); ++group) {
+            if (group_instances_[group] != instance || batch_group_offsets[group] == batch_group_offsets[group + 1])
+                continue;
+            group_command(group, keys, {}, {}, "HMGET", "MGET");
+            pipe.command(batch_args.begin(), batch_args.end());
+            ++commands_count;
+        }
+        if (!commands_count)
+            continue;
+
+        auto replies = pipeline ? execute(*pipeline) : execute(pipe);
+        if (!replies)
+            continue;
+        batch_queued_replies.push_back(std::move(*replies));
+
+        // Queued writes come first, our replies are the last ones
+        auto& queued_replies = batch_queued_replies.back();
+        size_t reply_idx = queued_replies.size() - commands_count;
+        for (size_t group = 0; group != group_instances_.size(); ++group) {
+            if (group_instances_[group] != instance || batch_group_offsets[group] == batch_group_offsets[group + 1])
+                continue;
+            redisReply const& reply = queued_replies.get(reply_idx++);
+            size_t group_length = batch_group_offsets[group + 1] - batch_group_offsets[group];
+            if (reply.type != REDIS_REPLY_ARRAY || reply.elements != group_length)
+                continue;
+            for (size_t i = 0; i != group_length; ++i)
+                batch_replies[batch_order[batch_group_offsets[group] + i]] = reply.element[i];
+        }
     }
 
-    auto pipe_replies = pipe.exec();
-
+    // Note: Values are copied from the raw replies right into the output buffer, in the order of keys
+    size_t offset = 0;
     size_t count = 0;
-    for (size_t i = 0; i != keys.size(); ++i)
-        count += pipe_replies.get<bool>(i);
+    for (auto reply : batch_replies) {
+        if (!reply || !export_value(*reply, values.data() + offset))
+            continue;
+        offset += reply->len;
+        ++count;
+    }
+    batch_queued_replies.clear();
+
+    return {count, count ? operation_status_t::ok_k : operation_status_t::error_k};
+}
 
-    return {count, operation_status_t::ok_k};
+operation_result_t redis_t::bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
+    return batch_upsert(keys, values, sizes);
 }
 
 operation_result_t redis_t::range_select(key_t /* key */, size_t /* length */, values_span_t /* values */) const {
@@ -279,10 +715,15 @@ operation_result_t redis_t::scan(key_t /* key */, size_t /* length */, value_spa
 
 std::string redis_t::info() { return {}; }
 
-void redis_t::flush() {}
+void redis_t::flush() {
+    // Note: Called once all the workers are done, so their pipelines are idle
+    for (auto& pipeline : pipelines_)
+        if (pipeline.pipe && pipeline.queued)
+            execute(pipeline);
+}
 
 size_t redis_t::size_on_disk() const { return 0; }
 
 std::unique_ptr<transaction_t> redis_t::create_transaction() { return {}; }
 
-} // namespace ucsb::redis
+} // namespace ucsb::redis
\ No newline at end of file
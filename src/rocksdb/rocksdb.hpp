@@ -12,6 +12,7 @@
 #include <rocksdb/write_batch.h>
 #include <rocksdb/utilities/options_util.h>
 #include <rocksdb/utilities/transaction_db.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
 #include <rocksdb/comparator.h>
@@ -31,6 +32,7 @@ using key_t = ucsb::key_t;
 using keys_spanc_t = ucsb::keys_spanc_t;
 using value_span_t = ucsb::value_span_t;
 using value_spanc_t = ucsb::value_spanc_t;
+using value_visitor_t = ucsb::value_visitor_t;
 using values_span_t = ucsb::values_span_t;
 using values_spanc_t = ucsb::values_spanc_t;
 using value_lengths_spanc_t = ucsb::value_lengths_spanc_t;
@@ -38,12 +40,22 @@ using operation_status_t = ucsb::operation_status_t;
 using operation_result_t = ucsb::operation_result_t;
 using db_hints_t = ucsb::db_hints_t;
 using transaction_t = ucsb::transaction_t;
+using async_read_t = ucsb::async_read_t;
 
 enum class db_mode_t {
     regular_k,
     transactional_k,
 };
 
+/**
+ * @brief Concurrency control of the transactional mode, selected in `additional.cfg`.
+ * Pessimistic one locks keys on write, optimistic one validates them on commit.
+ */
+enum class transaction_engine_t {
+    pessimistic_k,
+    optimistic_k,
+};
+
 /*
  * @brief Preallocated buffers used for batch operations.
  * Globals and especially `thread_local`s are a bad practice.
@@ -52,6 +64,21 @@ thread_local std::vector<key_t> batch_keys;
 thread_local std::vector<rocksdb::Slice> key_slices;
 thread_local std::vector<rocksdb::PinnableSlice> value_slices;
 thread_local std::vector<rocksdb::Status> statuses;
+thread_local rocksdb::WriteBatch write_batch;
+// Reads submitted by the logical clients of a thread, looked up together on the next poll
+thread_local std::vector<async_read_t*> submitted_reads;
+
+/**
+ * @brief Buffers only grow, but every lookup touches exactly the given count of their entries.
+ */
+inline void reserve_batch(size_t count) {
+    if (count <= batch_keys.size())
+        return;
+    batch_keys.resize(count);
+    key_slices.resize(count);
+    value_slices.resize(count);
+    statuses.resize(count);
+}
 
 /**
  * @brief RocksDB wrapper for the UCSB benchmark.
@@ -63,7 +90,8 @@ thread_local std::vector<rocksdb::Status> statuses;
 class rocksdb_t : public ucsb::db_t {
   public:
     inline rocksdb_t(db_mode_t mode = db_mode_t::regular_k)
-        : db_(nullptr), transaction_db_(nullptr), mode_(mode), full_compaction_(false) {}
+        : db_(nullptr), transaction_db_(nullptr), optimistic_transaction_db_(nullptr), mode_(mode),
+          transaction_engine_(transaction_engine_t::pessimistic_k), full_compaction_(false) {}
     ~rocksdb_t() { close(); }
 
     void set_config(fs::path const& config_path,
@@ -79,10 +107,18 @@ class rocksdb_t : public ucsb::db_t {
     operation_result_t update(key_t key, value_spanc_t value) override;
     operation_result_t remove(key_t key) override;
     operation_result_t read(key_t key, value_span_t value) const override;
+    operation_result_t read_borrowed(key_t key, value_span_t value, value_visitor_t const& visitor) const override;
 
     operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
     operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
 
+    /**
+     * @brief Queues the read, so all the reads of the thread's clients are looked up
+     * by a single `MultiGet` on the next poll, which is asynchronous with `async_io`.
+     */
+    void submit_read(async_read_t& request) const override;
+    void poll_completions() const override;
+
     operation_result_t bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
 
     operation_result_t range_select(key_t key, size_t length, values_span_t values) const override;
@@ -118,6 +154,7 @@ class rocksdb_t : public ucsb::db_t {
 
     rocksdb::Options options_;
     rocksdb::TransactionDBOptions transaction_options_;
+    rocksdb::OptimisticTransactionDBOptions optimistic_transaction_options_;
     rocksdb::ReadOptions read_options_;
     rocksdb::WriteOptions write_options_;
 
@@ -126,9 +163,16 @@ class rocksdb_t : public ucsb::db_t {
 
     std::unique_ptr<rocksdb::DB> db_;
     rocksdb::TransactionDB* transaction_db_;
+    rocksdb::OptimisticTransactionDB* optimistic_transaction_db_;
     key_comparator_t key_cmp_;
     db_mode_t mode_;
+    transaction_engine_t transaction_engine_;
     std::atomic_bool full_compaction_;
+
+    /**
+     * @brief Looks the keys up with a single `MultiGet`, leaving the results in the `thread_local` buffers.
+     */
+    inline void multiget(size_t count) const;
 };
 
 void rocksdb_t::set_config(fs::path const& config_path,
@@ -178,6 +222,15 @@ bool rocksdb_t::open(std::string& error) {
     rocksdb::DB* db_raw = nullptr;
     if (mode_ == db_mode_t::regular_k)
         status = rocksdb::DB::Open(options_, main_dir_path_.string(), cf_descs_, &cf_handles_, &db_raw);
+    else if (transaction_engine_ == transaction_engine_t::optimistic_k) {
+        status = rocksdb::OptimisticTransactionDB::Open(options_,
+                                                        optimistic_transaction_options_,
+                                                        main_dir_path_.string(),
+                                                        cf_descs_,
+                                                        &cf_handles_,
+                                                        &optimistic_transaction_db_);
+        db_raw = optimistic_transaction_db_;
+    }
     else {
         status = rocksdb::TransactionDB::Open(options_,
                                               transaction_options_,
@@ -200,11 +253,14 @@ void rocksdb_t::close() {
     key_slices.clear();
     value_slices.clear();
     statuses.clear();
+    write_batch.Clear();
+    submitted_reads.clear();
 
     db_.reset(nullptr);
     cf_descs_.clear();
     cf_handles_.clear();
     transaction_db_ = nullptr;
+    optimistic_transaction_db_ = nullptr;
 }
 
 operation_result_t rocksdb_t::upsert(key_t key, value_spanc_t value) {
@@ -245,46 +301,55 @@ operation_result_t rocksdb_t::read(key_t key, value_span_t value) const {
     return {1, operation_status_t::ok_k};
 }
 
+operation_result_t rocksdb_t::read_borrowed(key_t key, value_span_t, value_visitor_t const& visitor) const {
+    // Note: The slice pins the block cache entry or the memtable, so it stays valid until destroyed
+    rocksdb::PinnableSlice data;
+    rocksdb::Status status = db_->Get(read_options_, cf_handles_.front(), to_slice(key), &data);
+    if (status.IsNotFound())
+        return {0, operation_status_t::not_found_k};
+    else if (!status.ok())
+        return {0, operation_status_t::error_k};
+
+    visitor(value_spanc_t(reinterpret_cast<std::byte const*>(data.data()), data.size()));
+    return {1, operation_status_t::ok_k};
+}
+
 operation_result_t rocksdb_t::batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
 
+    // Note: Clearing keeps the underlying buffer, so the batch isn't reallocated on every call
     size_t offset = 0;
-    rocksdb::WriteBatch batch;
+    write_batch.Clear();
     for (size_t idx = 0; idx != keys.size(); ++idx) {
         key_t key = keys[idx];
-        batch.Put(to_slice(key), to_slice(values.subspan(offset, sizes[idx])));
+        write_batch.Put(to_slice(key), to_slice(values.subspan(offset, sizes[idx])));
         offset += sizes[idx];
     }
-    rocksdb::Status status = db_->Write(write_options_, &batch);
+    rocksdb::Status status = db_->Write(write_options_, &write_batch);
     return {keys.size(), status.ok() ? operation_status_t::ok_k : operation_status_t::error_k};
 }
 
-operation_result_t rocksdb_t::batch_read(keys_spanc_t keys, values_span_t values) const {
+inline void rocksdb_t::multiget(size_t count) const {
+    db_->MultiGet(read_options_, cf_handles_.front(), count, key_slices.data(), value_slices.data(), statuses.data());
+}
 
-    if (keys.size() > batch_keys.size()) {
-        batch_keys.resize(keys.size());
-        key_slices.resize(keys.size());
-        value_slices.resize(keys.size());
-        statuses.resize(keys.size());
-    }
+operation_result_t rocksdb_t::batch_read(keys_spanc_t keys, values_span_t values) const {
 
+    reserve_batch(keys.size());
     for (size_t idx = 0; idx != keys.size(); ++idx)
         key_slices[idx] = to_slice(batch_keys[idx] = keys[idx]);
+    multiget(keys.size());
 
-    db_->MultiGet(read_options_,
-                  cf_handles_.front(),
-                  key_slices.size(),
-                  key_slices.data(),
-                  value_slices.data(),
-                  statuses.data());
-
+    // Found values are packed one after another
     size_t offset = 0;
     size_t found_cnt = 0;
-    for (size_t i = 0; i != statuses.size(); ++i) {
+    for (size_t i = 0; i != keys.size(); ++i) {
         if (!statuses[i].ok())
             continue;
         memcpy(values.data() + offset, value_slices[i].data(), value_slices[i].size());
         offset += value_slices[i].size();
         ++found_cnt;
+        // Release pinned blocks right away, instead of holding them until the next batch
+        value_slices[i].Reset();
     }
 
     return {found_cnt, operation_status_t::ok_k};
@@ -370,6 +435,34 @@ operation_result_t rocksdb_t::scan(key_t key, size_t length, value_span_t single
     return {i, operation_status_t::ok_k};
 }
 
+void rocksdb_t::submit_read(async_read_t& request) const { submitted_reads.push_back(&request); }
+
+void rocksdb_t::poll_completions() const {
+    if (submitted_reads.empty())
+        return;
+
+    size_t count = submitted_reads.size();
+    reserve_batch(count);
+    for (size_t idx = 0; idx != count; ++idx)
+        key_slices[idx] = to_slice(batch_keys[idx] = submitted_reads[idx]->key);
+    multiget(count);
+
+    // Note: Completing only schedules the clients, so no read is submitted until all of these are done
+    for (size_t idx = 0; idx != count; ++idx) {
+        async_read_t& request = *submitted_reads[idx];
+        if (statuses[idx].IsNotFound())
+            request.complete({0, operation_status_t::not_found_k});
+        else if (!statuses[idx].ok())
+            request.complete({0, operation_status_t::error_k});
+        else {
+            memcpy(request.value.data(), value_slices[idx].data(), value_slices[idx].size());
+            request.complete({1, operation_status_t::ok_k});
+        }
+        value_slices[idx].Reset();
+    }
+    submitted_reads.clear();
+}
+
 std::string rocksdb_t::info() { return fmt::format("v{}.{}", rocksdb::kMajorVersion, rocksdb::kMinorVersion); }
 
 void rocksdb_t::flush() {
@@ -391,11 +484,10 @@ size_t rocksdb_t::size_on_disk() const {
 }
 
 std::unique_ptr<transaction_t> rocksdb_t::create_transaction() {
-
-    std::unique_ptr<rocksdb::Transaction> raw(transaction_db_->BeginTransaction(write_options_));
-    auto id = size_t(raw.get());
-    raw->SetName(std::to_string(id));
-    return std::make_unique<rocksdb_transaction_t>(std::move(raw), cf_handles_);
+    return std::make_unique<rocksdb_transaction_t>(transaction_db_,
+                                                   optimistic_transaction_db_,
+                                                   write_options_,
+                                                   cf_handles_);
 }
 
 bool rocksdb_t::load_additional_options() {
@@ -420,10 +512,48 @@ bool rocksdb_t::load_additional_options() {
     nlohmann::json j_config;
     i_config >> j_config;
 
+    // Transactions
+    std::string engine = j_config.value<std::string>("transaction_engine", "pessimistic");
+    if (engine == "pessimistic")
+        transaction_engine_ = transaction_engine_t::pessimistic_k;
+    else if (engine == "optimistic")
+        transaction_engine_ = transaction_engine_t::optimistic_k;
+    else
+        return false;
+
     transaction_options_.default_write_batch_flush_threshold =
         j_config["default_write_batch_flush_threshold"].get<int64_t>();
-    if (transaction_options_.default_write_batch_flush_threshold > 0)
+    // Note: Flushing the write batch before commit makes sense only for unprepared writes, so it's the default then
+    std::string write_policy = j_config.value<std::string>(
+        "write_policy",
+        transaction_options_.default_write_batch_flush_threshold > 0 ? "write_unprepared" : "write_committed");
+    if (write_policy == "write_committed")
+        transaction_options_.write_policy = rocksdb::TxnDBWritePolicy::WRITE_COMMITTED;
+    else if (write_policy == "write_prepared")
+        transaction_options_.write_policy = rocksdb::TxnDBWritePolicy::WRITE_PREPARED;
+    else if (write_policy == "write_unprepared")
         transaction_options_.write_policy = rocksdb::TxnDBWritePolicy::WRITE_UNPREPARED;
+    else
+        return false;
+    transaction_options_.transaction_lock_timeout =
+        j_config.value<int64_t>("transaction_lock_timeout", transaction_options_.transaction_lock_timeout);
+
+    std::string validate_policy = j_config.value<std::string>("optimistic_validate_policy", "parallel");
+    if (validate_policy == "parallel")
+        optimistic_transaction_options_.validate_policy = rocksdb::OccValidationPolicy::kValidateParallel;
+    else if (validate_policy == "serial")
+        optimistic_transaction_options_.validate_policy = rocksdb::OccValidationPolicy::kValidateSerial;
+    else
+        return false;
+
+    // Writes
+    // Note: Both are also configurable from the main `.cfg`, this overwrites them
+    options_.enable_pipelined_write = j_config.value<bool>("enable_pipelined_write", options_.enable_pipelined_write);
+    options_.unordered_write = j_config.value<bool>("unordered_write", options_.unordered_write);
+
+    // Reads
+    // Note: `async_io` needs RocksDB built with coroutines/io_uring support, otherwise it falls back to sync reads
+    read_options_.async_io = j_config.value<bool>("async_io", false);
 
     return true;
 }
@@ -4,9 +4,10 @@
 #include <vector>
 
 #include <rocksdb/utilities/transaction_db.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
 
 #include "src/core/types.hpp"
-#include "src/core/data_accessor.hpp"
+#include "src/core/db.hpp"
 
 namespace ucsb::facebook {
 
@@ -16,6 +17,7 @@ using key_t = ucsb::key_t;
 using keys_spanc_t = ucsb::keys_spanc_t;
 using value_span_t = ucsb::value_span_t;
 using value_spanc_t = ucsb::value_spanc_t;
+using value_visitor_t = ucsb::value_visitor_t;
 using values_span_t = ucsb::values_span_t;
 using values_spanc_t = ucsb::values_spanc_t;
 using value_lengths_spanc_t = ucsb::value_lengths_spanc_t;
@@ -32,6 +34,15 @@ inline rocksdb::Slice to_slice(value_spanc_t value) {
     return {reinterpret_cast<char const*>(value.data()), value.size()};
 }
 
+inline operation_status_t to_transaction_status(rocksdb::Status const& status) {
+    if (status.ok())
+        return operation_status_t::ok_k;
+    // Lock timeouts, deadlocks and failed validations mean the transaction has to be retried
+    if (status.IsBusy() || status.IsTimedOut() || status.IsTryAgain() || status.IsExpired())
+        return operation_status_t::conflict_k;
+    return operation_status_t::error_k;
+}
+
 /*
  * @brief Preallocated buffers used for batch operations.
  * Globals and especially `thread_local`s are a bad practice.
@@ -48,17 +59,28 @@ thread_local std::vector<rocksdb::Status> transaction_statuses;
  */
 class rocksdb_transaction_t : public ucsb::transaction_t {
   public:
-    inline rocksdb_transaction_t(std::unique_ptr<rocksdb::Transaction> transaction,
+    /**
+     * @brief Exactly one of `db` and `optimistic_db` must be set.
+     */
+    inline rocksdb_transaction_t(rocksdb::TransactionDB* db,
+                                 rocksdb::OptimisticTransactionDB* optimistic_db,
+                                 rocksdb::WriteOptions const& write_options,
                                  std::vector<rocksdb::ColumnFamilyHandle*> const& cf_handles)
-        : transaction_(std::move(transaction)), cf_handles_(cf_handles) {
+        : db_(db), optimistic_db_(optimistic_db), write_options_(write_options), cf_handles_(cf_handles) {
         read_options_.verify_checksums = false;
+        begin();
     }
     ~rocksdb_transaction_t();
 
+    operation_status_t commit() override;
+    void rollback() override;
+    void set_explicit_boundaries(bool explicit_boundaries) override { explicit_boundaries_ = explicit_boundaries; }
+
     operation_result_t upsert(key_t key, value_spanc_t value) override;
     operation_result_t update(key_t key, value_spanc_t value) override;
     operation_result_t remove(key_t key) override;
     operation_result_t read(key_t key, value_span_t value) const override;
+    operation_result_t read_borrowed(key_t key, value_span_t value, value_visitor_t const& visitor) const override;
 
     operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
     operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
@@ -69,10 +91,19 @@ class rocksdb_transaction_t : public ucsb::transaction_t {
     operation_result_t scan(key_t key, size_t length, value_span_t single_value) const override;
 
   private:
+    /**
+     * @brief Begins a new transaction reusing the memory of the previous one.
+     */
+    void begin();
+
+    rocksdb::TransactionDB* db_;
+    rocksdb::OptimisticTransactionDB* optimistic_db_;
+    rocksdb::WriteOptions write_options_;
     std::unique_ptr<rocksdb::Transaction> transaction_;
     std::vector<rocksdb::ColumnFamilyHandle*> cf_handles_;
 
     rocksdb::ReadOptions read_options_;
+    bool explicit_boundaries_ = false;
 };
 
 rocksdb_transaction_t::~rocksdb_transaction_t() {
@@ -81,21 +112,52 @@ rocksdb_transaction_t::~rocksdb_transaction_t() {
     transaction_value_slices.clear();
     transaction_statuses.clear();
 
-    auto status = transaction_->Commit();
+    [[maybe_unused]] auto status = transaction_->Commit();
     assert(status.ok());
 }
 
+void rocksdb_transaction_t::begin() {
+    rocksdb::Transaction* raw = nullptr;
+    if (optimistic_db_)
+        raw = optimistic_db_->BeginTransaction(write_options_,
+                                               rocksdb::OptimisticTransactionOptions(),
+                                               transaction_.get());
+    else
+        raw = db_->BeginTransaction(write_options_, rocksdb::TransactionOptions(), transaction_.get());
+    if (raw != transaction_.get())
+        transaction_.reset(raw);
+
+    // Note: Optimistic transactions can't be named
+    if (!optimistic_db_) {
+        auto id = size_t(raw);
+        raw->SetName(std::to_string(id));
+    }
+}
+
+operation_status_t rocksdb_transaction_t::commit() {
+    rocksdb::Status status = transaction_->Commit();
+    if (!status.ok())
+        transaction_->Rollback();
+    begin();
+    return to_transaction_status(status);
+}
+
+void rocksdb_transaction_t::rollback() {
+    transaction_->Rollback();
+    begin();
+}
+
+/**
+ * Note: Without explicit boundaries the single long transaction of the thread is committed, when RocksDB
+ * can't grow it any more. Otherwise that would split a transaction of the benchmark, so the conflict
+ * is reported and the benchmark retries the whole transaction.
+ */
 operation_result_t rocksdb_transaction_t::upsert(key_t key, value_spanc_t value) {
     auto key_slice = to_slice(key);
     rocksdb::Status status = transaction_->Put(key_slice, to_slice(value));
-    if (!status.ok()) {
-        assert(status.IsTryAgain());
-        status = transaction_->Commit();
-        assert(status.ok());
+    if (status.IsTryAgain() && !explicit_boundaries_ && commit() == operation_status_t::ok_k)
         status = transaction_->Put(key_slice, to_slice(value));
-        assert(status.ok());
-    }
-    return {size_t(status.ok()), status.ok() ? operation_status_t::ok_k : operation_status_t::error_k};
+    return {size_t(status.ok()), to_transaction_status(status)};
 }
 
 operation_result_t rocksdb_transaction_t::update(key_t key, value_spanc_t value) {
@@ -105,7 +167,7 @@ operation_result_t rocksdb_transaction_t::update(key_t key, value_spanc_t value)
     if (status.IsNotFound())
         return {0, operation_status_t::not_found_k};
     else if (!status.ok())
-        return {0, operation_status_t::error_k};
+        return {0, to_transaction_status(status)};
 
     return upsert(original_key, value);
 }
@@ -113,15 +175,9 @@ operation_result_t rocksdb_transaction_t::update(key_t key, value_spanc_t value)
 operation_result_t rocksdb_transaction_t::remove(key_t key) {
     auto key_slice = to_slice(key);
     rocksdb::Status status = transaction_->Delete(key_slice);
-    if (!status.ok()) {
-        assert(status.IsTryAgain());
-        status = transaction_->Commit();
-        assert(status.ok());
+    if (status.IsTryAgain() && !explicit_boundaries_ && commit() == operation_status_t::ok_k)
         status = transaction_->Delete(key_slice);
-        assert(status.ok());
-    }
-
-    return {size_t(status.ok()), status.ok() ? operation_status_t::ok_k : operation_status_t::error_k};
+    return {size_t(status.ok()), to_transaction_status(status)};
 }
 
 operation_result_t rocksdb_transaction_t::read(key_t key, value_span_t value) const {
@@ -130,12 +186,26 @@ operation_result_t rocksdb_transaction_t::read(key_t key, value_span_t value) co
     if (status.IsNotFound())
         return {0, operation_status_t::not_found_k};
     else if (!status.ok())
-        return {0, operation_status_t::error_k};
+        return {0, to_transaction_status(status)};
 
     memcpy(value.data(), data.data(), data.size());
     return {1, operation_status_t::ok_k};
 }
 
+operation_result_t rocksdb_transaction_t::read_borrowed(key_t key,
+                                                        value_span_t,
+                                                        value_visitor_t const& visitor) const {
+    rocksdb::PinnableSlice data;
+    rocksdb::Status status = transaction_->Get(read_options_, to_slice(key), &data);
+    if (status.IsNotFound())
+        return {0, operation_status_t::not_found_k};
+    else if (!status.ok())
+        return {0, to_transaction_status(status)};
+
+    visitor(value_spanc_t(reinterpret_cast<std::byte const*>(data.data()), data.size()));
+    return {1, operation_status_t::ok_k};
+}
+
 operation_result_t rocksdb_transaction_t::batch_upsert(keys_spanc_t keys,
                                                        values_spanc_t values,
                                                        value_lengths_spanc_t sizes) {
@@ -145,13 +215,10 @@ operation_result_t rocksdb_transaction_t::batch_upsert(keys_spanc_t keys,
         auto key = keys[idx];
         auto key_slice = to_slice(key);
         rocksdb::Status status = transaction_->Put(key_slice, to_slice(values.subspan(offset, sizes[idx])));
-        if (!status.ok()) {
-            assert(status.IsTryAgain());
-            status = transaction_->Commit();
-            assert(status.ok());
+        if (status.IsTryAgain() && !explicit_boundaries_ && commit() == operation_status_t::ok_k)
             status = transaction_->Put(key_slice, to_slice(values.subspan(offset, sizes[idx])));
-            assert(status.ok());
-        }
+        if (!status.ok())
+            return {idx, to_transaction_status(status)};
         offset += sizes[idx];
     }
     return {keys.size(), operation_status_t::ok_k};
@@ -171,20 +238,21 @@ operation_result_t rocksdb_transaction_t::batch_read(keys_spanc_t keys, values_s
 
     transaction_->MultiGet(read_options_,
                            cf_handles_.front(),
-                           transaction_key_slices.size(),
+                           keys.size(),
                            transaction_key_slices.data(),
                            transaction_value_slices.data(),
                            transaction_statuses.data());
 
     size_t offset = 0;
     size_t found_cnt = 0;
-    for (size_t i = 0; i < transaction_statuses.size(); ++i) {
+    for (size_t i = 0; i < keys.size(); ++i) {
         if (!transaction_statuses[i].ok())
             continue;
 
         memcpy(values.data() + offset, transaction_value_slices[i].data(), transaction_value_slices[i].size());
         offset += transaction_value_slices[i].size();
         ++found_cnt;
+        transaction_value_slices[i].Reset();
     }
 
     return {found_cnt, operation_status_t::ok_k};
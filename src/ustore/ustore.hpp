@@ -1,10 +1,14 @@
 #pragma once
 
+#include <deque>
+#include <mutex>
 #include <cassert>
 #include <string>
 #include <fstream>
 #include <streambuf>
 
+#include <nlohmann/json.hpp>
+
 #include <ustore/ustore.h>
 #include <ustore/cpp/status.hpp>
 #include <ustore/cpp/types.hpp>
@@ -35,9 +39,9 @@ using transaction_t = ucsb::transaction_t;
 
 struct client_t {
     ustore_database_t db = nullptr;
-    ustore_arena_t memory = nullptr;
-
-    operator bool() const noexcept { return db != nullptr; }
+    // Note: The arena is owned by the DB and reused by all the operations of a thread
+    ustore_arena_t* memory = nullptr;
+    size_t state = 0;
 };
 
 /**
@@ -55,6 +59,7 @@ class ustore_t : public ucsb::db_t {
                     db_hints_t const& hints) override;
     bool open(std::string& error) override;
     void close() override;
+    void rebind_threads() override;
 
     std::string info() override;
 
@@ -80,6 +85,10 @@ class ustore_t : public ucsb::db_t {
   private:
     void free();
     inline void map_client() const;
+    /**
+     * @brief Reads and removes the benchmark-specific part of the UStore config.
+     */
+    inline bool load_benchmark_options(std::string& str_config, std::string& error);
 
   private:
     fs::path config_path_;
@@ -89,14 +98,21 @@ class ustore_t : public ucsb::db_t {
 
     ustore_collection_t collection_ = ustore_collection_main_k;
     ustore_options_t options_ = ustore_options_default_k;
+    size_t scan_chunk_length_ = 1'000'000;
 
     std::vector<client_t> clients_;
+    size_t state_ = 0;
+    // One arena per client slot, a deque keeps them in place while new ones are added
+    mutable std::deque<ustore_arena_t> arenas_;
+    mutable std::mutex arenas_mutex_;
     static thread_local client_t client_;
     static std::atomic_size_t client_index_;
+    static std::atomic_size_t states_count_;
 };
 
 thread_local client_t ustore_t::client_;
 std::atomic_size_t ustore_t::client_index_ = 0;
+std::atomic_size_t ustore_t::states_count_ = 0;
 
 void ustore_t::set_config(fs::path const& config_path,
                           fs::path const& main_dir_path,
@@ -109,7 +125,7 @@ void ustore_t::set_config(fs::path const& config_path,
 }
 
 bool ustore_t::open(std::string& error) {
-    if (client_)
+    if (!clients_.empty())
         return true;
 
     // Read config from file
@@ -119,6 +135,8 @@ bool ustore_t::open(std::string& error) {
         return false;
     }
     std::string str_config((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    if (!load_benchmark_options(str_config, error))
+        return false;
 
     // Load and overwrite
     ustore::config_t config;
@@ -186,6 +204,40 @@ bool ustore_t::open(std::string& error) {
             return status;
         }
     }
+    rebind_threads();
+    return true;
+}
+
+void ustore_t::rebind_threads() {
+    client_index_.store(0);
+    state_ = ++states_count_;
+}
+
+inline bool ustore_t::load_benchmark_options(std::string& str_config, std::string& error) {
+    auto j_config = nlohmann::json::parse(str_config, nullptr, false, true);
+    if (j_config.is_discarded()) {
+        error = "Invalid config";
+        return false;
+    }
+
+    options_ = ustore_options_default_k;
+    scan_chunk_length_ = 1'000'000;
+    if (!j_config.contains("benchmark"))
+        return true;
+
+    // Note: UStore doesn't know these, so they are removed before loading the rest
+    auto j_options = j_config["benchmark"];
+    j_config.erase("benchmark");
+    str_config = j_config.dump();
+
+    // Values are exported from the shared memory of the engine instead of being copied into the arena
+    if (j_options.value<bool>("read_shared_memory", false))
+        options_ = ustore_options_t(options_ | ustore_option_read_shared_memory_k);
+    // Transactions don't track the keys they read, so only write-write conflicts abort them
+    if (j_options.value<bool>("transaction_dont_watch", false))
+        options_ = ustore_options_t(options_ | ustore_option_transaction_dont_watch_k);
+    scan_chunk_length_ = std::max<size_t>(j_options.value<size_t>("scan_chunk_length", 1'000'000), 1);
+
     return true;
 }
 
@@ -197,22 +249,32 @@ void ustore_t::close() {
 }
 
 void ustore_t::free() {
-    for (std::size_t i = 0; i < clients_.size(); ++i) {
-        ustore_arena_free(clients_[i].memory);
-        ustore_database_free(clients_[i].db);
+    {
+        std::lock_guard lock(arenas_mutex_);
+        for (auto arena : arenas_)
+            ustore_arena_free(arena);
+        arenas_.clear();
     }
+    for (std::size_t i = 0; i < clients_.size(); ++i)
+        ustore_database_free(clients_[i].db);
     clients_.clear();
-    client_.db = nullptr;
-    client_.memory = nullptr;
+    client_ = client_t {};
 }
 
 inline void ustore_t::map_client() const {
-    if (!client_) [[unlikely]] {
+    if (client_.state != state_) [[unlikely]] {
+        // Note: Threads of every benchmark take the slots anew, so the arenas of the slots are reused
+        std::size_t slot = client_index_.fetch_add(1);
         std::size_t index = 0;
 #if defined(USTORE_ENGINE_IS_FLIGHT_CLIENT)
-        index = client_index_.fetch_add(1);
+        index = slot;
 #endif
-        client_ = clients_[index];
+        client_.db = clients_[index].db;
+        std::lock_guard lock(arenas_mutex_);
+        while (arenas_.size() <= slot)
+            arenas_.emplace_back(nullptr);
+        client_.memory = &arenas_[slot];
+        client_.state = state_;
     }
 }
 
@@ -227,7 +289,7 @@ operation_result_t ustore_t::upsert(key_t key, value_spanc_t value) {
     ustore_write_t write {};
     write.db = client_.db;
     write.error = status.member_ptr();
-    write.arena = &client_.memory;
+    write.arena = client_.memory;
     write.options = options_;
     write.tasks_count = 1;
     write.collections = &collection_;
@@ -249,7 +311,7 @@ operation_result_t ustore_t::update(key_t key, value_spanc_t value) {
     ustore_read_t read {};
     read.db = client_.db;
     read.error = status.member_ptr();
-    read.arena = &client_.memory;
+    read.arena = client_.memory;
     read.options = options_;
     read.tasks_count = 1;
     read.collections = &collection_;
@@ -271,7 +333,7 @@ operation_result_t ustore_t::remove(key_t key) {
     ustore_write_t write {};
     write.db = client_.db;
     write.error = status.member_ptr();
-    write.arena = &client_.memory;
+    write.arena = client_.memory;
     write.options = options_;
     write.tasks_count = 1;
     write.collections = &collection_;
@@ -292,7 +354,7 @@ operation_result_t ustore_t::read(key_t key, value_span_t value) const {
     ustore_read_t read {};
     read.db = client_.db;
     read.error = status.member_ptr();
-    read.arena = &client_.memory;
+    read.arena = client_.memory;
     read.options = options_;
     read.tasks_count = 1;
     read.collections = &collection_;
@@ -323,7 +385,7 @@ operation_result_t ustore_t::batch_upsert(keys_spanc_t keys, values_spanc_t valu
     ustore_write_t write {};
     write.db = client_.db;
     write.error = status.member_ptr();
-    write.arena = &client_.memory;
+    write.arena = client_.memory;
     write.options = options_;
     write.tasks_count = keys.size();
     write.collections = &collection_;
@@ -351,7 +413,7 @@ operation_result_t ustore_t::batch_read(keys_spanc_t keys, values_span_t values)
     ustore_read_t read {};
     read.db = client_.db;
     read.error = status.member_ptr();
-    read.arena = &client_.memory;
+    read.arena = client_.memory;
     read.options = options_;
     read.tasks_count = keys.size();
     read.collections = &collection_;
@@ -395,7 +457,7 @@ operation_result_t ustore_t::range_select(key_t key, size_t length, values_span_
     ustore_scan_t scan {};
     scan.db = client_.db;
     scan.error = status.member_ptr();
-    scan.arena = &client_.memory;
+    scan.arena = client_.memory;
     scan.options = options_;
     scan.tasks_count = 1;
     scan.collections = &collection_;
@@ -415,7 +477,7 @@ operation_result_t ustore_t::range_select(key_t key, size_t length, values_span_
     ustore_read_t read {};
     read.db = client_.db;
     read.error = status.member_ptr();
-    read.arena = &client_.memory;
+    read.arena = client_.memory;
     read.options = ustore_options_t(options_ | ustore_option_dont_discard_memory_k);
     read.tasks_count = *found_counts;
     read.collections = &collection_;
@@ -429,14 +491,17 @@ operation_result_t ustore_t::range_select(key_t key, size_t length, values_span_
         return {0, operation_status_t::error_k};
 
     size_t offset = 0;
+    size_t selected_records_count = 0;
     for (size_t idx = 0; idx < *found_counts; ++idx) {
         if (lengths[idx] == ustore_length_missing_k)
             continue;
         memcpy(values.data() + offset, values_ + offsets[idx], lengths[idx]);
         offset += lengths[idx];
+        ++selected_records_count;
     }
 
-    return {*found_counts, *found_counts > 0 ? operation_status_t::ok_k : operation_status_t::not_found_k};
+    return {selected_records_count,
+            selected_records_count > 0 ? operation_status_t::ok_k : operation_status_t::not_found_k};
 }
 
 operation_result_t ustore_t::scan(key_t key, size_t length, value_span_t single_value) const {
@@ -444,8 +509,8 @@ operation_result_t ustore_t::scan(key_t key, size_t length, value_span_t single_
 
     ustore::status_t status;
     ustore_key_t key_ = key;
-    ustore_length_t len =
-        std::min<ustore_length_t>(length, 1'000'000); // Note: Don't scan all at once because the DB might be very big
+    // Note: Don't scan all at once because the DB might be very big
+    ustore_length_t len = 0;
     ustore_length_t* found_counts = nullptr;
     ustore_key_t* found_keys = nullptr;
 
@@ -457,7 +522,7 @@ operation_result_t ustore_t::scan(key_t key, size_t length, value_span_t single_
     ustore_scan_t scan {};
     scan.db = client_.db;
     scan.error = status.member_ptr();
-    scan.arena = &client_.memory;
+    scan.arena = client_.memory;
     scan.options = options_;
     scan.tasks_count = 1;
     scan.collections = &collection_;
@@ -470,7 +535,7 @@ operation_result_t ustore_t::scan(key_t key, size_t length, value_span_t single_
     ustore_read_t read {};
     read.db = client_.db;
     read.error = status.member_ptr();
-    read.arena = &client_.memory;
+    read.arena = client_.memory;
     read.options = ustore_options_t(options_ | ustore_option_dont_discard_memory_k);
     read.collections = &collection_;
     read.keys_stride = sizeof(ustore_key_t);
@@ -478,15 +543,17 @@ operation_result_t ustore_t::scan(key_t key, size_t length, value_span_t single_
     read.lengths = &lengths;
     read.values = &values_;
 
-    ustore_length_t scanned = 0;
-    ustore_length_t remaining_keys_cnt = length;
-    while (remaining_keys_cnt) {
+    size_t scanned = 0;
+    while (scanned < length) {
         // First scan
+        len = std::min<size_t>(length - scanned, scan_chunk_length_);
         ustore_scan(&scan);
         if (!status)
             return {0, operation_status_t::error_k};
+        if (!*found_counts)
+            break;
 
-        // Then read
+        // Then read, the found keys stay in the arena
         read.tasks_count = *found_counts;
         read.keys = found_keys;
         ustore_read(&read);
@@ -498,9 +565,10 @@ operation_result_t ustore_t::scan(key_t key, size_t length, value_span_t single_
             if (lengths[idx] != ustore_length_missing_k)
                 memcpy(single_value.data(), values_ + offsets[idx], lengths[idx]);
 
-        key_ += len;
-        remaining_keys_cnt = remaining_keys_cnt - len;
-        len = std::min(len, remaining_keys_cnt);
+        // Continue right after the last found key, as keys may be sparse
+        if (*found_counts < len)
+            break;
+        key_ = found_keys[*found_counts - 1] + 1;
     }
 
     return {scanned, scanned > 0 ? operation_status_t::ok_k : operation_status_t::not_found_k};
@@ -516,7 +584,7 @@ void ustore_t::flush() {
     ustore_write_t write {};
     write.db = client_.db;
     write.error = status.member_ptr();
-    write.arena = &client_.memory;
+    write.arena = client_.memory;
     write.options = ustore_options_t(options_ | ustore_option_write_flush_k);
     write.tasks_count = 0;
     write.collections = &collection_;
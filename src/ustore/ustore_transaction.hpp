@@ -4,7 +4,7 @@
 #include <ustore/cpp/status.hpp>
 
 #include "src/core/types.hpp"
-#include "src/core/data_accessor.hpp"
+#include "src/core/db.hpp"
 
 namespace ucsb::ustore {
 
@@ -33,6 +33,10 @@ class ustore_transact_t : public ucsb::transaction_t {
         : db_(db), transaction_(transaction), arena_(db_) {}
     ~ustore_transact_t();
 
+    operation_status_t commit() override;
+    void rollback() override;
+    void set_explicit_boundaries(bool explicit_boundaries) override { explicit_boundaries_ = explicit_boundaries; }
+
     operation_result_t upsert(key_t key, value_spanc_t value) override;
     operation_result_t update(key_t key, value_spanc_t value) override;
     operation_result_t remove(key_t key) override;
@@ -47,7 +51,7 @@ class ustore_transact_t : public ucsb::transaction_t {
     operation_result_t scan(key_t key, size_t length, value_span_t single_value) const override;
 
   private:
-    inline ustore::status_t commit() {
+    inline ustore::status_t commit_transaction() {
         ustore::status_t status;
         ustore_transaction_commit_t txn_commit {};
         txn_commit.db = db_;
@@ -58,19 +62,63 @@ class ustore_transact_t : public ucsb::transaction_t {
         return status;
     }
 
+    /**
+     * @brief Resets the transaction handle to begin a new one.
+     */
+    inline void begin() {
+        ustore::status_t status;
+        ustore_transaction_init_t txn_init {};
+        txn_init.db = db_;
+        txn_init.error = status.member_ptr();
+        txn_init.transaction = &transaction_;
+        ustore_transaction_init(&txn_init);
+        assert(status);
+    }
+
+    /**
+     * @brief Without explicit boundaries a failed write commits the changes so far
+     * and is retried on a fresh transaction. Otherwise it aborts the benchmark's transaction.
+     * Note: UStore doesn't tell conflicts from other errors.
+     */
+    inline bool retry_write(ustore::status_t& status) {
+        if (status || explicit_boundaries_)
+            return false;
+        bool committed = bool(commit_transaction());
+        begin();
+        if (!committed)
+            return false;
+        status.release_exception();
+        return true;
+    }
+    inline operation_status_t write_status(ustore::status_t const& status) const {
+        if (status)
+            return operation_status_t::ok_k;
+        return explicit_boundaries_ ? operation_status_t::conflict_k : operation_status_t::error_k;
+    }
+
     ustore_database_t db_;
     ustore_transaction_t transaction_;
     ustore_collection_t collection_ = ustore_collection_main_k;
     ustore_options_t options_ = ustore_options_default_k;
     ustore::arena_t mutable arena_;
+    bool explicit_boundaries_ = false;
 };
 
 ustore_transact_t::~ustore_transact_t() {
-    [[maybe_unused]] auto status = commit();
+    [[maybe_unused]] auto status = commit_transaction();
     assert(status);
     ustore_transaction_free(transaction_);
 }
 
+operation_status_t ustore_transact_t::commit() {
+    // Note: UStore doesn't tell conflicts from other errors, so any failed commit is considered a conflict
+    auto status = commit_transaction();
+    begin();
+    return status ? operation_status_t::ok_k : operation_status_t::conflict_k;
+}
+
+void ustore_transact_t::rollback() { begin(); }
+
 operation_result_t ustore_transact_t::upsert(key_t key, value_spanc_t value) {
     ustore::status_t status;
     ustore_key_t key_ = key;
@@ -89,12 +137,12 @@ operation_result_t ustore_transact_t::upsert(key_t key, value_spanc_t value) {
     write.lengths = reinterpret_cast<ustore_length_t const*>(&length);
     write.values = value_.member_ptr();
     ustore_write(&write);
-    if (!status && commit()) {
-        status.release_exception();
+    if (retry_write(status)) {
+        write.transaction = transaction_;
         ustore_write(&write);
     }
 
-    return {size_t(status), status ? operation_status_t::ok_k : operation_status_t::error_k};
+    return {size_t(status), write_status(status)};
 }
 
 operation_result_t ustore_transact_t::update(key_t key, value_spanc_t value) {
@@ -133,12 +181,12 @@ operation_result_t ustore_transact_t::remove(key_t key) {
     write.collections = &collection_;
     write.keys = &key_;
     ustore_write(&write);
-    if (!status && commit()) {
-        status.release_exception();
+    if (retry_write(status)) {
+        write.transaction = transaction_;
         ustore_write(&write);
     }
 
-    return {status ? size_t(1) : 0, status ? operation_status_t::ok_k : operation_status_t::error_k};
+    return {status ? size_t(1) : 0, write_status(status)};
 }
 
 operation_result_t ustore_transact_t::read(key_t key, value_span_t value) const {
@@ -195,12 +243,12 @@ operation_result_t ustore_transact_t::batch_upsert(keys_spanc_t keys,
     write.lengths_stride = sizeof(ustore_length_t);
     write.values = values_.member_ptr();
     ustore_write(&write);
-    if (!status && commit()) {
-        status.release_exception();
+    if (retry_write(status)) {
+        write.transaction = transaction_;
         ustore_write(&write);
     }
 
-    return {status ? keys.size() : 0, status ? operation_status_t::ok_k : operation_status_t::error_k};
+    return {status ? keys.size() : 0, write_status(status)};
 }
 
 operation_result_t ustore_transact_t::batch_read(keys_spanc_t keys, values_span_t values) const {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -11,6 +13,8 @@
 #include "src/core/helper.hpp"
 #include "src/core/printable.hpp"
 
+#include "wiredtiger_transaction.hpp"
+
 namespace ucsb::mongo {
 
 namespace fs = ucsb::fs;
@@ -19,6 +23,7 @@ using key_t = ucsb::key_t;
 using keys_spanc_t = ucsb::keys_spanc_t;
 using value_span_t = ucsb::value_span_t;
 using value_spanc_t = ucsb::value_spanc_t;
+using value_visitor_t = ucsb::value_visitor_t;
 using values_span_t = ucsb::values_span_t;
 using values_spanc_t = ucsb::values_spanc_t;
 using value_lengths_spanc_t = ucsb::value_lengths_spanc_t;
@@ -26,6 +31,26 @@ using operation_status_t = ucsb::operation_status_t;
 using operation_result_t = ucsb::operation_result_t;
 using db_hints_t = ucsb::db_hints_t;
 using transaction_t = ucsb::transaction_t;
+using db_statistics_t = ucsb::db_statistics_t;
+
+/**
+ * @brief Maps a key into its partition.
+ * Partitions split the keys into equal ranges, the same way workloads
+ * split them between threads, so with as many partitions as threads
+ * every thread mostly writes to its own table.
+ */
+inline size_t key_partition(key_t key, size_t records_count, size_t partitions_count) {
+    if (partitions_count == 1)
+        return 0;
+
+    size_t partition_length = records_count / partitions_count;
+    size_t leftover = records_count % partitions_count;
+    // Note: The first `leftover` partitions are one key longer
+    size_t long_keys = leftover * (partition_length + 1);
+    size_t partition = key < long_keys ? key / (partition_length + 1)
+                                       : leftover + (key - long_keys) / std::max(partition_length, size_t(1));
+    return std::min(partition, partitions_count - 1);
+}
 
 /**
  * @brief WiredTiger wrapper for the UCSB benchmark.
@@ -33,8 +58,10 @@ using transaction_t = ucsb::transaction_t;
  * https://github.com/wiredtiger/wiredtiger
  */
 class wiredtiger_t : public ucsb::db_t {
+    friend class wiredtiger_transaction_t;
+
   public:
-    inline wiredtiger_t() : conn_(nullptr), table_name_("table:access"), state_(0), bulk_load_cursor_(nullptr) {}
+    inline wiredtiger_t() : conn_(nullptr), table_name_("table:access"), partitions_count_(1), transaction_flush_threshold_(0), state_(0), statistics_session_(nullptr) {}
     ~wiredtiger_t() override = default;
 
     void set_config(fs::path const& config_path,
@@ -43,6 +70,7 @@ class wiredtiger_t : public ucsb::db_t {
                     db_hints_t const& hints) override;
     bool open(std::string& error) override;
     void close() override;
+    void rebind_threads() override;
 
     std::string info() override;
 
@@ -50,6 +78,7 @@ class wiredtiger_t : public ucsb::db_t {
     operation_result_t update(key_t key, value_spanc_t value) override;
     operation_result_t remove(key_t key) override;
     operation_result_t read(key_t key, value_span_t value) const override;
+    operation_result_t read_borrowed(key_t key, value_span_t value, value_visitor_t const& visitor) const override;
 
     operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
     operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
@@ -62,19 +91,67 @@ class wiredtiger_t : public ucsb::db_t {
     void flush() override;
 
     size_t size_on_disk() const override;
+    /**
+     * @brief Reads the configured `statistics_counters` from a `statistics:` cursor.
+     * Those are only collected if `statistics` isn't "none".
+     */
+    db_statistics_t statistics() const override;
 
     std::unique_ptr<transaction_t> create_transaction() override;
 
   private:
+    // Note: Zero and empty values keep the WiredTiger defaults
     struct config_t {
         size_t cache_size = 0;
+        size_t partitions_count = 1;
+        size_t transaction_flush_threshold = 0;
+
+        // Connection
+        size_t session_max = 0;
+        bool mmap = true;
+        size_t eviction_threads_min = 0;
+        size_t eviction_threads_max = 0;
+        size_t eviction_target = 0;
+        size_t eviction_trigger = 0;
+        size_t eviction_dirty_target = 0;
+        size_t eviction_dirty_trigger = 0;
+        size_t checkpoint_wait = 0;
+        size_t checkpoint_log_size = 0;
+        bool log_enabled = false;
+        std::string log_compressor;
+        std::string statistics;
+        size_t statistics_log_wait = 0;
+        std::vector<std::string> statistics_counters;
+
+        // Table
+        std::string block_compressor;
+        size_t leaf_page_max = 0;
+        size_t internal_page_max = 0;
+        size_t memory_page_max = 0;
     };
 
     inline bool load_config(config_t& config);
     inline std::string create_str_config(config_t const& config) const;
+    inline std::string create_table_str_config(config_t const& config) const;
 
-    inline WT_CURSOR* open_cursor(char const* config = nullptr) const;
-    inline void close_cursor(WT_CURSOR* cursor) const;
+    inline WT_CURSOR* open_cursor(WT_SESSION* session, size_t partition, char const* config = nullptr) const;
+    inline size_t session_idx() const;
+    inline size_t partition_of(key_t key) const {
+        return key_partition(key, hints_.records_count, partitions_count_);
+    }
+    /**
+     * @brief Returns the long-lived cursor of the caller thread's session.
+     * It must be given back with `release_cursor` after every operation.
+     */
+    inline WT_CURSOR* session_cursor(size_t partition) const;
+    inline WT_CURSOR* scan_cursor(size_t partition) const;
+    inline WT_CURSOR* load_cursor(size_t partition);
+    inline WT_CURSOR* bulk_load_cursor(size_t session, size_t partition);
+    inline void release_cursor(WT_CURSOR* cursor) const;
+    /**
+     * @brief Moves the scan cursor to the next entry, continuing into the next partitions.
+     */
+    inline int next_entry(WT_CURSOR*& cursor, size_t& partition) const;
 
   private:
     fs::path config_path_;
@@ -84,13 +161,29 @@ class wiredtiger_t : public ucsb::db_t {
 
     WT_CONNECTION* conn_;
     std::string table_name_;
+    std::vector<std::string> partition_names_;
+    size_t partitions_count_;
+    size_t transaction_flush_threshold_;
 
     size_t state_;
     std::vector<WT_SESSION*> sessions_;
     mutable std::atomic_size_t free_sessions_count_;
 
-    // Special cursor for bulk load
-    WT_CURSOR* bulk_load_cursor_;
+    // A separate session, as statistics are sampled while other threads may still run
+    WT_SESSION* statistics_session_;
+    std::vector<std::string> statistics_counters_;
+
+    // One cursor for point operations and one read-only cursor for ranges per session and partition
+    mutable std::vector<WT_CURSOR*> cursors_;
+    mutable std::vector<WT_CURSOR*> scan_cursors_;
+
+    // Cursors inserting without overwrites, used by bulk loads of many sessions
+    std::vector<WT_CURSOR*> load_cursors_;
+
+    // Special cursors for bulk load, only used if there is a single session, see `bulk_load`
+    std::vector<WT_CURSOR*> bulk_load_cursors_;
+    std::vector<size_t> bulk_load_sessions_;
+    std::mutex bulk_load_mutex_;
 };
 
 inline int compare_keys(
@@ -132,6 +225,16 @@ bool wiredtiger_t::open(std::string& error) {
         return false;
     }
 
+    // Note: A single partition keeps the original table name
+    partitions_count_ = std::max(config.partitions_count, size_t(1));
+    transaction_flush_threshold_ = config.transaction_flush_threshold;
+    partition_names_.clear();
+    if (partitions_count_ == 1)
+        partition_names_.push_back(table_name_);
+    else
+        for (size_t i = 0; i < partitions_count_; ++i)
+            partition_names_.push_back(fmt::format("{}_{}", table_name_, i));
+
     std::string str_config = create_str_config(config);
     int res = wiredtiger_open(main_dir_path_.c_str(), NULL, str_config.c_str(), &conn_);
     if (res) {
@@ -147,34 +250,78 @@ bool wiredtiger_t::open(std::string& error) {
         if (res)
             break;
         sessions_.push_back(session);
-        res = session->create(session, table_name_.c_str(), "key_format=Q,value_format=u");
-        if (res)
-            break;
     }
     if (sessions_.size() != hints_.threads_count) {
         close();
         return false;
     }
+    std::string table_str_config = create_table_str_config(config);
+    for (auto const& partition_name : partition_names_) {
+        WT_SESSION* session = sessions_.front();
+        auto res = session->create(session, partition_name.c_str(), table_str_config.c_str());
+        if (res) {
+            close();
+            return false;
+        }
+    }
 
-    ++state_;
-    free_sessions_count_.store(sessions_.size());
+    statistics_counters_.clear();
+    if (!config.statistics.empty() && config.statistics != "none") {
+        res = conn_->open_session(conn_, NULL, NULL, &statistics_session_);
+        if (res) {
+            statistics_session_ = nullptr;
+            close();
+            return false;
+        }
+        statistics_counters_ = config.statistics_counters;
+    }
+
+    // Note: Cursors are opened on first use, as a bulk load needs exclusive access to the table
+    cursors_.assign(sessions_.size() * partitions_count_, nullptr);
+    scan_cursors_.assign(sessions_.size() * partitions_count_, nullptr);
+    load_cursors_.assign(sessions_.size() * partitions_count_, nullptr);
+    bulk_load_cursors_.assign(partitions_count_, nullptr);
+    bulk_load_sessions_.assign(partitions_count_, sessions_.size());
 
+    rebind_threads();
     return true;
 }
 
+void wiredtiger_t::rebind_threads() {
+    ++state_;
+    free_sessions_count_.store(sessions_.size());
+}
+
 void wiredtiger_t::close() {
     if (!conn_)
         return;
 
     free_sessions_count_.store(0);
+    // Note: Closing a session also closes all of its cursors
+    cursors_.clear();
+    scan_cursors_.clear();
+    load_cursors_.clear();
+    bulk_load_cursors_.clear();
+    bulk_load_sessions_.clear();
     for (auto session : sessions_)
         session->close(session, NULL);
     sessions_.clear();
+    if (statistics_session_)
+        statistics_session_->close(statistics_session_, NULL);
+    statistics_session_ = nullptr;
     conn_->close(conn_, NULL);
     conn_ = nullptr;
 }
 
-inline WT_CURSOR* wiredtiger_t::open_cursor(char const* config) const {
+inline WT_CURSOR* wiredtiger_t::open_cursor(WT_SESSION* session, size_t partition, char const* config) const {
+    WT_CURSOR* cursor = nullptr;
+    auto res = session->open_cursor(session, partition_names_[partition].c_str(), NULL, config, &cursor);
+    if (res)
+        return nullptr;
+    return cursor;
+}
+
+inline size_t wiredtiger_t::session_idx() const {
     // Resolve session for the caller thread
     thread_local size_t session_idx = 0;
     thread_local size_t session_state = 0;
@@ -183,26 +330,74 @@ inline WT_CURSOR* wiredtiger_t::open_cursor(char const* config) const {
         if (request_idx >= sessions_.size()) {
             // Revert
             ++free_sessions_count_;
-            return nullptr;
+            return sessions_.size();
         }
         session_idx = request_idx;
         session_state = state_;
     }
+    return session_idx;
+}
 
-    // Note: Cursor is cached by default, so it doesn't open new cursor for the same session
-    WT_CURSOR* cursor = nullptr;
-    WT_SESSION* session = sessions_[session_idx];
-    auto res = session->open_cursor(session, table_name_.c_str(), NULL, config, &cursor);
-    if (res)
+inline WT_CURSOR* wiredtiger_t::session_cursor(size_t partition) const {
+    size_t idx = session_idx();
+    if (idx >= sessions_.size())
+        return nullptr;
+    WT_CURSOR*& cursor = cursors_[idx * partitions_count_ + partition];
+    if (!cursor) [[unlikely]]
+        cursor = open_cursor(sessions_[idx], partition);
+    return cursor;
+}
+
+inline WT_CURSOR* wiredtiger_t::scan_cursor(size_t partition) const {
+    size_t idx = session_idx();
+    if (idx >= sessions_.size())
+        return nullptr;
+    WT_CURSOR*& cursor = scan_cursors_[idx * partitions_count_ + partition];
+    if (!cursor) [[unlikely]]
+        cursor = open_cursor(sessions_[idx], partition, "readonly=true");
+    return cursor;
+}
+
+inline WT_CURSOR* wiredtiger_t::load_cursor(size_t partition) {
+    size_t idx = session_idx();
+    if (idx >= sessions_.size())
         return nullptr;
+    WT_CURSOR*& cursor = load_cursors_[idx * partitions_count_ + partition];
+    if (!cursor) [[unlikely]]
+        cursor = open_cursor(sessions_[idx], partition, "overwrite=false");
     return cursor;
 }
 
-inline void wiredtiger_t::close_cursor(WT_CURSOR* cursor) const { cursor->close(cursor); }
+inline WT_CURSOR* wiredtiger_t::bulk_load_cursor(size_t session, size_t partition) {
+    std::lock_guard lock(bulk_load_mutex_);
+    if (bulk_load_sessions_[partition] == sessions_.size()) {
+        bulk_load_sessions_[partition] = session;
+        bulk_load_cursors_[partition] = open_cursor(sessions_[session], partition, "bulk");
+    }
+    return bulk_load_sessions_[partition] == session ? bulk_load_cursors_[partition] : nullptr;
+}
+
+// Note: Reset drops the position, so the cursor doesn't pin pages between operations
+inline void wiredtiger_t::release_cursor(WT_CURSOR* cursor) const { cursor->reset(cursor); }
+
+inline int wiredtiger_t::next_entry(WT_CURSOR*& cursor, size_t& partition) const {
+    int res = cursor->next(cursor);
+    while (res == WT_NOTFOUND && partition + 1 < partitions_count_) {
+        WT_CURSOR* next_cursor = scan_cursor(partition + 1);
+        if (!next_cursor)
+            break;
+        release_cursor(cursor);
+        cursor = next_cursor;
+        ++partition;
+        // Note: A freshly reset cursor moves to the first entry
+        res = cursor->next(cursor);
+    }
+    return res;
+}
 
 operation_result_t wiredtiger_t::upsert(key_t key, value_spanc_t value) {
 
-    WT_CURSOR* cursor = open_cursor();
+    WT_CURSOR* cursor = session_cursor(partition_of(key));
     if (!cursor)
         return {0, operation_status_t::error_k};
 
@@ -212,14 +407,14 @@ operation_result_t wiredtiger_t::upsert(key_t key, value_spanc_t value) {
     db_value.size = value.size();
     cursor->set_value(cursor, &db_value);
     auto res = cursor->insert(cursor);
-    close_cursor(cursor);
+    release_cursor(cursor);
 
     return {size_t(res == 0), res == 0 ? operation_status_t::ok_k : operation_status_t::error_k};
 }
 
 operation_result_t wiredtiger_t::update(key_t key, value_spanc_t value) {
 
-    WT_CURSOR* cursor = open_cursor();
+    WT_CURSOR* cursor = session_cursor(partition_of(key));
     if (!cursor)
         return {0, operation_status_t::error_k};
 
@@ -229,20 +424,20 @@ operation_result_t wiredtiger_t::update(key_t key, value_spanc_t value) {
     db_value.size = value.size();
     cursor->set_value(cursor, &db_value);
     auto res = cursor->update(cursor);
-    close_cursor(cursor);
+    release_cursor(cursor);
 
     return {size_t(res == 0), res == 0 ? operation_status_t::ok_k : operation_status_t::error_k};
 }
 
 operation_result_t wiredtiger_t::remove(key_t key) {
 
-    WT_CURSOR* cursor = open_cursor();
+    WT_CURSOR* cursor = session_cursor(partition_of(key));
     if (!cursor)
         return {0, operation_status_t::error_k};
 
     cursor->set_key(cursor, key);
     auto res = cursor->remove(cursor);
-    close_cursor(cursor);
+    release_cursor(cursor);
 
     bool ok = res == 0 || res == WT_NOTFOUND;
     return {size_t(ok), ok ? operation_status_t::ok_k : operation_status_t::error_k};
@@ -250,35 +445,68 @@ operation_result_t wiredtiger_t::remove(key_t key) {
 
 operation_result_t wiredtiger_t::read(key_t key, value_span_t value) const {
 
-    WT_CURSOR* cursor = open_cursor();
+    WT_CURSOR* cursor = session_cursor(partition_of(key));
     if (!cursor)
         return {0, operation_status_t::error_k};
 
     cursor->set_key(cursor, key);
     auto res = cursor->search(cursor);
-    if (res)
+    WT_ITEM db_value;
+    if (res == 0)
+        res = cursor->get_value(cursor, &db_value);
+    if (res) {
+        release_cursor(cursor);
         return {0, operation_status_t::not_found_k};
+    }
 
+    // Note: The value memory is owned by the cursor, so it must be copied before the reset
+    memcpy(value.data(), db_value.data, db_value.size);
+    release_cursor(cursor);
+
+    return {1, operation_status_t::ok_k};
+}
+
+operation_result_t wiredtiger_t::read_borrowed(key_t key, value_span_t, value_visitor_t const& visitor) const {
+
+    WT_CURSOR* cursor = session_cursor(partition_of(key));
+    if (!cursor)
+        return {0, operation_status_t::error_k};
+
+    cursor->set_key(cursor, key);
+    auto res = cursor->search(cursor);
     WT_ITEM db_value;
-    res = cursor->get_value(cursor, &db_value);
-    close_cursor(cursor);
-    if (res)
+    if (res == 0)
+        res = cursor->get_value(cursor, &db_value);
+    if (res) {
+        release_cursor(cursor);
         return {0, operation_status_t::not_found_k};
+    }
 
-    memcpy(value.data(), db_value.data, db_value.size);
+    // Note: The value memory is owned by the cursor, so it's only visited before the reset
+    visitor(value_spanc_t(reinterpret_cast<std::byte const*>(db_value.data), db_value.size));
+    release_cursor(cursor);
 
     return {1, operation_status_t::ok_k};
 }
 
 operation_result_t wiredtiger_t::batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
 
-   WT_CURSOR* cursor = open_cursor();
+    size_t partition = partition_of(keys.front());
+    WT_CURSOR* cursor = session_cursor(partition);
     if (!cursor)
         return {0, operation_status_t::error_k};
 
     size_t offset = 0;
     size_t upserted = 0;
     for (size_t idx = 0; idx < keys.size(); ++idx) {
+        if (partition_of(keys[idx]) != partition) {
+            WT_CURSOR* next_cursor = session_cursor(partition_of(keys[idx]));
+            if (!next_cursor)
+                break;
+            release_cursor(cursor);
+            cursor = next_cursor;
+            partition = partition_of(keys[idx]);
+        }
         cursor->set_key(cursor, keys[idx]);
         WT_ITEM db_value;
         db_value.data = values.data() + offset;
@@ -289,14 +517,15 @@ operation_result_t wiredtiger_t::batch_upsert(keys_spanc_t keys, values_spanc_t
             upserted++;
         offset += sizes[idx];
     }
-    close_cursor(cursor);
+    release_cursor(cursor);
 
     return {upserted, operation_status_t::ok_k};
 }
 
 operation_result_t wiredtiger_t::batch_read(keys_spanc_t keys, values_span_t values) const {
 
-   WT_CURSOR* cursor = open_cursor();
+    size_t partition = partition_of(keys.front());
+    WT_CURSOR* cursor = session_cursor(partition);
     if (!cursor)
         return {0, operation_status_t::error_k};
 
@@ -304,6 +533,14 @@ operation_result_t wiredtiger_t::batch_read(keys_spanc_t keys, values_span_t val
     size_t offset = 0;
     size_t found_cnt = 0;
     for (auto key : keys) {
+        if (partition_of(key) != partition) {
+            WT_CURSOR* next_cursor = session_cursor(partition_of(key));
+            if (!next_cursor)
+                break;
+            release_cursor(cursor);
+            cursor = next_cursor;
+            partition = partition_of(key);
+        }
         WT_ITEM db_value;
         cursor->set_key(cursor, key);
         int res = cursor->search(cursor);
@@ -316,8 +553,7 @@ operation_result_t wiredtiger_t::batch_read(keys_spanc_t keys, values_span_t val
             }
         }
     }
-    close_cursor(cursor);
-
+    release_cursor(cursor);
 
     return {found_cnt, operation_status_t::ok_k};
 }
@@ -325,45 +561,69 @@ operation_result_t wiredtiger_t::batch_read(keys_spanc_t keys, values_span_t val
 operation_result_t wiredtiger_t::bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) {
     // Warnings:
     //   DB must be empty
-    //   This is single thread interface
+    //   Keys of a single thread are ascending, so they come in runs of the same partition
 
-    if (!bulk_load_cursor_) {
-        bulk_load_cursor_ = open_cursor("bulk");
-        if (!bulk_load_cursor_)
-            return {0, operation_status_t::error_k};
-    }
+    size_t session = session_idx();
+    if (session >= sessions_.size())
+        return {0, operation_status_t::error_k};
 
     size_t offset = 0;
-    for (size_t idx = 0; idx < keys.size(); ++idx) {
-        bulk_load_cursor_->set_key(bulk_load_cursor_, keys[idx]);
-        WT_ITEM db_value;
-        db_value.data = &values[offset];
-        db_value.size = sizes[idx];
-        bulk_load_cursor_->set_value(bulk_load_cursor_, &db_value);
-        bulk_load_cursor_->insert(bulk_load_cursor_);
-        offset += sizes[idx];
+    size_t loaded = 0;
+    for (size_t begin = 0; begin != keys.size();) {
+        size_t partition = partition_of(keys[begin]);
+        size_t end = begin + 1;
+        while (end != keys.size() && partition_of(keys[end]) == partition)
+            ++end;
+
+        // Note: A bulk cursor needs exclusive access to its table, but key ranges of threads don't
+        // match the partitions exactly, so other sessions may write to any of them at the same time.
+        // Thus bulk cursors are only used by a single session, many sessions insert into the separate
+        // tables of partitions in parallel. Partitions, which can't be bulk loaded, as they aren't
+        // empty anymore, are also loaded with inserts.
+        WT_CURSOR* cursor = sessions_.size() == 1 ? bulk_load_cursor(session, partition) : nullptr;
+        bool is_bulk = cursor;
+        if (!is_bulk)
+            cursor = load_cursor(partition);
+        if (!cursor)
+            return {loaded, operation_status_t::error_k};
+
+        for (size_t idx = begin; idx != end; ++idx) {
+            cursor->set_key(cursor, keys[idx]);
+            WT_ITEM db_value;
+            db_value.data = &values[offset];
+            db_value.size = sizes[idx];
+            cursor->set_value(cursor, &db_value);
+            loaded += cursor->insert(cursor) == 0;
+            offset += sizes[idx];
+        }
+        if (!is_bulk)
+            release_cursor(cursor);
+        begin = end;
     }
 
-    return {keys.size(), operation_status_t::ok_k};
+    return {loaded, operation_status_t::ok_k};
 }
 
 operation_result_t wiredtiger_t::range_select(key_t key, size_t length, values_span_t values) const {
 
-    WT_CURSOR* cursor = open_cursor();
+    size_t partition = partition_of(key);
+    WT_CURSOR* cursor = scan_cursor(partition);
     if (!cursor)
         return {0, operation_status_t::error_k};
 
     cursor->set_key(cursor, key);
     auto res = cursor->search(cursor);
-    if (res)
+    if (res) {
+        release_cursor(cursor);
         return {0, operation_status_t::error_k};
+    }
 
     size_t i = 0;
     WT_ITEM db_value;
     const char* db_key = nullptr;
     size_t offset = 0;
     size_t selected_records_count = 0;
-    while ((res = cursor->next(cursor)) == 0 && i++ < length) {
+    while ((res = next_entry(cursor, partition)) == 0 && i++ < length) {
         res = cursor->get_key(cursor, &db_key);
         res |= cursor->get_value(cursor, &db_value);
         if (res == 0) {
@@ -372,27 +632,30 @@ operation_result_t wiredtiger_t::range_select(key_t key, size_t length, values_s
             ++selected_records_count;
         }
     }
-    close_cursor(cursor);
+    release_cursor(cursor);
 
     return {selected_records_count, operation_status_t::ok_k};
 }
 
 operation_result_t wiredtiger_t::scan(key_t key, size_t length, value_span_t single_value) const {
 
-    WT_CURSOR* cursor = open_cursor();
+    size_t partition = partition_of(key);
+    WT_CURSOR* cursor = scan_cursor(partition);
     if (!cursor)
         return {0, operation_status_t::error_k};
 
     cursor->set_key(cursor, key);
     auto res = cursor->search(cursor);
-    if (res)
+    if (res) {
+        release_cursor(cursor);
         return {0, operation_status_t::error_k};
+    }
 
     size_t i = 0;
     WT_ITEM db_value;
     const char* db_key = nullptr;
     size_t scanned_records_count = 0;
-    while ((res = cursor->next(cursor)) == 0 && i++ < length) {
+    while ((res = next_entry(cursor, partition)) == 0 && i++ < length) {
         res = cursor->get_key(cursor, &db_key);
         res |= cursor->get_value(cursor, &db_value);
         if (res == 0) {
@@ -400,7 +663,7 @@ operation_result_t wiredtiger_t::scan(key_t key, size_t length, value_span_t sin
             ++scanned_records_count;
         }
     }
-    close_cursor(cursor);
+    release_cursor(cursor);
 
     return {scanned_records_count, operation_status_t::ok_k};
 }
@@ -410,15 +673,59 @@ std::string wiredtiger_t::info() {
 }
 
 void wiredtiger_t::flush() {
-    if (bulk_load_cursor_) {
-        close_cursor(bulk_load_cursor_);
-        bulk_load_cursor_ = nullptr;
+    std::lock_guard lock(bulk_load_mutex_);
+    for (auto& cursor : bulk_load_cursors_) {
+        if (cursor)
+            cursor->close(cursor);
+        cursor = nullptr;
     }
+    // Note: Partitions aren't empty anymore, so next bulk loads will fail to open bulk cursors and fall back to inserts
+    bulk_load_sessions_.assign(partitions_count_, sessions_.size());
 }
 
 size_t wiredtiger_t::size_on_disk() const { return ucsb::size_on_disk(main_dir_path_); }
 
-std::unique_ptr<transaction_t> wiredtiger_t::create_transaction() { return {}; }
+db_statistics_t wiredtiger_t::statistics() const {
+    if (!statistics_session_ || statistics_counters_.empty())
+        return {};
+
+    WT_CURSOR* cursor = nullptr;
+    auto res = statistics_session_->open_cursor(statistics_session_, "statistics:", NULL, NULL, &cursor);
+    if (res)
+        return {};
+
+    db_statistics_t statistics;
+    char const* description = nullptr;
+    char const* printable_value = nullptr;
+    int64_t value = 0;
+    while (cursor->next(cursor) == 0) {
+        if (cursor->get_value(cursor, &description, &printable_value, &value))
+            continue;
+        // Note: The list is short, so a linear search is fine
+        auto it = std::find(statistics_counters_.begin(), statistics_counters_.end(), description);
+        if (it != statistics_counters_.end())
+            statistics.emplace_back(fmt::format("wt:{}", description), double(value));
+    }
+    cursor->close(cursor);
+
+    return statistics;
+}
+
+std::unique_ptr<transaction_t> wiredtiger_t::create_transaction() {
+    if (!conn_)
+        return {};
+
+    // Note: Every transaction owns a separate session, next to the ones of the regular operations
+    WT_SESSION* session = nullptr;
+    auto res = conn_->open_session(conn_, NULL, NULL, &session);
+    if (res)
+        return {};
+    return std::make_unique<wiredtiger_transaction_t>(session, *this, partition_names_, transaction_flush_threshold_);
+}
+
+inline size_t wiredtiger_transaction_t::partition_of(key_t key) const {
+    return db_.partition_of(key);
+}
 
 bool wiredtiger_t::load_config(config_t& config) {
     if (!fs::exists(config_path_))
@@ -429,6 +736,44 @@ bool wiredtiger_t::load_config(config_t& config) {
     i_config >> j_config;
 
     config.cache_size = j_config.value<size_t>("cache_size", 100'000'000);
+    config.partitions_count = j_config.value<size_t>("partitions_count", 1);
+    config.transaction_flush_threshold = j_config.value<size_t>("transaction_flush_threshold", 0);
+
+    config.session_max = j_config.value<size_t>("session_max", 0);
+    config.mmap = j_config.value<bool>("mmap", true);
+    config.eviction_threads_min = j_config.value<size_t>("eviction_threads_min", 0);
+    config.eviction_threads_max = j_config.value<size_t>("eviction_threads_max", 0);
+    config.eviction_target = j_config.value<size_t>("eviction_target", 0);
+    config.eviction_trigger = j_config.value<size_t>("eviction_trigger", 0);
+    config.eviction_dirty_target = j_config.value<size_t>("eviction_dirty_target", 0);
+    config.eviction_dirty_trigger = j_config.value<size_t>("eviction_dirty_trigger", 0);
+    config.checkpoint_wait = j_config.value<size_t>("checkpoint_wait", 0);
+    config.checkpoint_log_size = j_config.value<size_t>("checkpoint_log_size", 0);
+    config.log_enabled = j_config.value<bool>("log_enabled", false);
+    config.log_compressor = j_config.value<std::string>("log_compressor", "");
+    config.statistics = j_config.value<std::string>("statistics", "none");
+    config.statistics_log_wait = j_config.value<size_t>("statistics_log_wait", 0);
+    config.statistics_counters = j_config.value<std::vector<std::string>>( //
+        "statistics_counters",
+        {
+            "cache: bytes currently in the cache",
+            "cache: tracked dirty bytes in the cache",
+            "cache: pages evicted by application threads",
+            "cache: eviction worker thread evicting pages",
+            "cache: pages read into cache",
+            "cache: pages written from cache",
+            "block-manager: bytes read",
+            "block-manager: bytes written",
+            "transaction: transaction checkpoints",
+        });
+
+    config.block_compressor = j_config.value<std::string>("block_compressor", "");
+    config.leaf_page_max = j_config.value<size_t>("leaf_page_max", 0);
+    config.internal_page_max = j_config.value<size_t>("internal_page_max", 0);
+    config.memory_page_max = j_config.value<size_t>("memory_page_max", 0);
+
+    if (config.statistics != "none" && config.statistics != "fast" && config.statistics != "all")
+        return false;
 
     return true;
 }
@@ -437,7 +782,68 @@ inline std::string wiredtiger_t::create_str_config(config_t const& config) const
 
     std::string str_config = "create";
     std::string str_cache_size = fmt::format("cache_size={:.0M}", ucsb::printable_bytes_t {config.cache_size});
-    return fmt::format("{},{}", str_config, str_cache_size);
+    str_config = fmt::format("{},{}", str_config, str_cache_size);
+
+    if (config.session_max)
+        str_config += fmt::format(",session_max={}", config.session_max);
+    str_config += fmt::format(",mmap={}", config.mmap);
+
+    std::string str_eviction;
+    if (config.eviction_threads_min)
+        str_eviction += fmt::format("threads_min={},", config.eviction_threads_min);
+    if (config.eviction_threads_max)
+        str_eviction += fmt::format("threads_max={},", config.eviction_threads_max);
+    if (!str_eviction.empty()) {
+        str_eviction.pop_back();
+        str_config += fmt::format(",eviction=({})", str_eviction);
+    }
+    // Note: Targets and triggers are percents of the cache size
+    if (config.eviction_target)
+        str_config += fmt::format(",eviction_target={}", config.eviction_target);
+    if (config.eviction_trigger)
+        str_config += fmt::format(",eviction_trigger={}", config.eviction_trigger);
+    if (config.eviction_dirty_target)
+        str_config += fmt::format(",eviction_dirty_target={}", config.eviction_dirty_target);
+    if (config.eviction_dirty_trigger)
+        str_config += fmt::format(",eviction_dirty_trigger={}", config.eviction_dirty_trigger);
+
+    std::string str_checkpoint;
+    if (config.checkpoint_wait)
+        str_checkpoint += fmt::format("wait={},", config.checkpoint_wait);
+    if (config.checkpoint_log_size)
+        str_checkpoint += fmt::format("log_size={},", config.checkpoint_log_size);
+    if (!str_checkpoint.empty()) {
+        str_checkpoint.pop_back();
+        str_config += fmt::format(",checkpoint=({})", str_checkpoint);
+    }
+
+    if (config.log_enabled) {
+        if (config.log_compressor.empty())
+            str_config += ",log=(enabled=true)";
+        else
+            str_config += fmt::format(",log=(enabled=true,compressor={})", config.log_compressor);
+    }
+
+    str_config += fmt::format(",statistics=({})", config.statistics);
+    // Note: Periodic dumps are written by WiredTiger itself into `WiredTigerStat.*` files in the DB directory
+    if (config.statistics != "none" && config.statistics_log_wait)
+        str_config += fmt::format(",statistics_log=(wait={},json=true,on_close=true)", config.statistics_log_wait);
+
+    return str_config;
+}
+
+inline std::string wiredtiger_t::create_table_str_config(config_t const& config) const {
+
+    std::string str_config = "key_format=Q,value_format=u";
+    if (!config.block_compressor.empty())
+        str_config += fmt::format(",block_compressor={}", config.block_compressor);
+    if (config.leaf_page_max)
+        str_config += fmt::format(",leaf_page_max={}", config.leaf_page_max);
+    if (config.internal_page_max)
+        str_config += fmt::format(",internal_page_max={}", config.internal_page_max);
+    if (config.memory_page_max)
+        str_config += fmt::format(",memory_page_max={}", config.memory_page_max);
+    return str_config;
 }
 
 } // namespace ucsb::mongo
\ No newline at end of file
@@ -0,0 +1,453 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <wiredtiger.h>
+
+#include "src/core/types.hpp"
+#include "src/core/db.hpp"
+
+namespace ucsb::mongo {
+
+using key_t = ucsb::key_t;
+using keys_spanc_t = ucsb::keys_spanc_t;
+using value_span_t = ucsb::value_span_t;
+using value_spanc_t = ucsb::value_spanc_t;
+using value_visitor_t = ucsb::value_visitor_t;
+using values_span_t = ucsb::values_span_t;
+using values_spanc_t = ucsb::values_spanc_t;
+using value_lengths_spanc_t = ucsb::value_lengths_spanc_t;
+using operation_status_t = ucsb::operation_status_t;
+using operation_result_t = ucsb::operation_result_t;
+
+class wiredtiger_t;
+
+inline operation_status_t to_transaction_status(int res) {
+    if (res == 0)
+        return operation_status_t::ok_k;
+    if (res == WT_NOTFOUND)
+        return operation_status_t::not_found_k;
+    // Write conflicts and cache pressure roll the whole transaction back
+    if (res == WT_ROLLBACK || res == WT_PREPARE_CONFLICT)
+        return operation_status_t::conflict_k;
+    return operation_status_t::error_k;
+}
+
+/**
+ * @brief WiredTiger transactional wrapper for the UCSB benchmark.
+ * Every object owns a session with snapshot isolation, so all the
+ * operations between two commits see a single consistent snapshot
+ * and concurrent writes of the same keys conflict.
+ */
+class wiredtiger_transaction_t : public ucsb::transaction_t {
+  public:
+    /**
+     * @brief Takes the ownership of the `session`, keys are partitioned the same way as in the `db`.
+     * @param flush_threshold Commits automatically after that many writes, if not zero.
+     * It only applies if the benchmark doesn't set the transaction boundaries itself.
+     */
+    inline wiredtiger_transaction_t(WT_SESSION* session,
+                                    wiredtiger_t const& db,
+                                    std::vector<std::string> const& partition_names,
+                                    size_t flush_threshold)
+        : session_(session), db_(db), partition_names_(partition_names), flush_threshold_(flush_threshold),
+          explicit_boundaries_(false), transactions_count_(0), writes_count_(0), done_operations_(0), done_writes_(0),
+          rolled_back_operations_(0), rolled_back_writes_(0), cursors_(partition_names.size(), nullptr) {
+        begin();
+    }
+    ~wiredtiger_transaction_t();
+
+    operation_status_t commit() override;
+    void rollback() override;
+    void set_explicit_boundaries(bool explicit_boundaries) override { explicit_boundaries_ = explicit_boundaries; }
+    std::pair<size_t, size_t> take_rolled_back_writes() override;
+
+    operation_result_t upsert(key_t key, value_spanc_t value) override;
+    operation_result_t update(key_t key, value_spanc_t value) override;
+    operation_result_t remove(key_t key) override;
+    operation_result_t read(key_t key, value_span_t value) const override;
+    operation_result_t read_borrowed(key_t key, value_span_t value, value_visitor_t const& visitor) const override;
+
+    operation_result_t batch_upsert(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
+    operation_result_t batch_read(keys_spanc_t keys, values_span_t values) const override;
+
+    operation_result_t bulk_load(keys_spanc_t keys, values_spanc_t values, value_lengths_spanc_t sizes) override;
+
+    operation_result_t range_select(key_t key, size_t length, values_span_t values) const override;
+    operation_result_t scan(key_t key, size_t length, value_span_t single_value) const override;
+
+  private:
+    // Note: Marks where an operation started, to find which of its writes are still in the open transaction
+    struct write_mark_t {
+        size_t transaction = 0;
+        size_t writes = 0;
+    };
+
+    inline void begin() const;
+    // Note: Defined next to `wiredtiger_t`, which owns the partitioning
+    inline size_t partition_of(key_t key) const;
+    inline WT_CURSOR* cursor(size_t partition) const;
+    inline int next_entry(WT_CURSOR*& cursor, size_t& partition) const;
+    /**
+     * @brief WiredTiger requires a rolled back transaction to be finished before
+     * anything else, so a conflict immediately begins the next transaction.
+     */
+    inline int conclude(int res) const;
+    /**
+     * @brief Also commits the transaction once the flush threshold is reached.
+     */
+    inline int conclude_write(int res);
+    inline write_mark_t mark_writes() const { return {transactions_count_, writes_count_}; }
+    /**
+     * @brief Remembers a write operation reported as done, if some of its writes are in the open transaction.
+     * Writes of a failed operation are never remembered, as it isn't counted as done anyway.
+     */
+    inline void conclude_operation(write_mark_t mark);
+    inline int insert(key_t key, value_spanc_t value);
+    /**
+     * @brief Without explicit boundaries the writes were already reported as done,
+     * so the ones discarded with the transaction are remembered to be reported as failed.
+     */
+    inline void lose_writes() const;
+
+    WT_SESSION* session_;
+    wiredtiger_t const& db_;
+    std::vector<std::string> partition_names_;
+    size_t flush_threshold_;
+    bool explicit_boundaries_;
+    mutable size_t transactions_count_;
+    // Successful writes since the transaction began
+    mutable size_t writes_count_;
+    // Operations reported as done since the transaction began and their writes in it
+    mutable size_t done_operations_;
+    mutable size_t done_writes_;
+    mutable size_t rolled_back_operations_;
+    mutable size_t rolled_back_writes_;
+    // Note: Cursors outlive transactions, they are only reset between operations
+    mutable std::vector<WT_CURSOR*> cursors_;
+};
+
+wiredtiger_transaction_t::~wiredtiger_transaction_t() {
+    [[maybe_unused]] auto res = session_->commit_transaction(session_, NULL);
+    assert(res == 0);
+    // Note: Closing a session also closes all of its cursors
+    session_->close(session_, NULL);
+}
+
+inline void wiredtiger_transaction_t::begin() const {
+    ++transactions_count_;
+    writes_count_ = 0;
+    done_operations_ = 0;
+    done_writes_ = 0;
+    [[maybe_unused]] auto res = session_->begin_transaction(session_, "isolation=snapshot");
+    assert(res == 0);
+}
+
+inline WT_CURSOR* wiredtiger_transaction_t::cursor(size_t partition) const {
+    WT_CURSOR*& cursor = cursors_[partition];
+    if (!cursor) [[unlikely]] {
+        auto res = session_->open_cursor(session_, partition_names_[partition].c_str(), NULL, NULL, &cursor);
+        if (res)
+            cursor = nullptr;
+    }
+    return cursor;
+}
+
+inline int wiredtiger_transaction_t::next_entry(WT_CURSOR*& current, size_t& partition) const {
+    int res = current->next(current);
+    while (res == WT_NOTFOUND && partition + 1 < partition_names_.size()) {
+        WT_CURSOR* next_cursor = cursor(partition + 1);
+        if (!next_cursor)
+            break;
+        current->reset(current);
+        current = next_cursor;
+        ++partition;
+        // Note: A freshly reset cursor moves to the first entry
+        res = current->next(current);
+    }
+    return res;
+}
+
+inline void wiredtiger_transaction_t::lose_writes() const {
+    if (explicit_boundaries_)
+        return;
+    rolled_back_operations_ += done_operations_;
+    rolled_back_writes_ += done_writes_;
+}
+
+inline int wiredtiger_transaction_t::conclude(int res) const {
+    if (to_transaction_status(res) == operation_status_t::conflict_k) {
+        session_->rollback_transaction(session_, NULL);
+        lose_writes();
+        begin();
+    }
+    return res;
+}
+
+inline int wiredtiger_transaction_t::conclude_write(int res) {
+    if (res || explicit_boundaries_ || !flush_threshold_ || writes_count_ + 1 < flush_threshold_) {
+        writes_count_ += size_t(res == 0);
+        return conclude(res);
+    }
+
+    // Note: The current write isn't counted yet, as it fails on its own if the commit does
+    res = session_->commit_transaction(session_, NULL);
+    if (res)
+        lose_writes();
+    begin();
+    return res ? WT_ROLLBACK : 0;
+}
+
+inline void wiredtiger_transaction_t::conclude_operation(write_mark_t mark) {
+    // Note: Writes before a commit in the middle of the operation can't be lost anymore
+    size_t writes = mark.transaction == transactions_count_ ? writes_count_ - mark.writes : writes_count_;
+    if (!writes)
+        return;
+    ++done_operations_;
+    done_writes_ += writes;
+}
+
+inline int wiredtiger_transaction_t::insert(key_t key, value_spanc_t value) {
+    WT_CURSOR* cursor = this->cursor(partition_of(key));
+    if (!cursor)
+        return WT_ERROR;
+
+    cursor->set_key(cursor, key);
+    WT_ITEM db_value;
+    db_value.data = value.data();
+    db_value.size = value.size();
+    cursor->set_value(cursor, &db_value);
+    auto res = cursor->insert(cursor);
+    cursor->reset(cursor);
+
+    return conclude_write(res);
+}
+
+operation_status_t wiredtiger_transaction_t::commit() {
+    // Note: A failed commit is rolled back by WiredTiger itself
+    auto res = session_->commit_transaction(session_, NULL);
+    if (res)
+        lose_writes();
+    begin();
+    return to_transaction_status(res);
+}
+
+void wiredtiger_transaction_t::rollback() {
+    session_->rollback_transaction(session_, NULL);
+    lose_writes();
+    begin();
+}
+
+std::pair<size_t, size_t> wiredtiger_transaction_t::take_rolled_back_writes() {
+    auto counts = std::make_pair(rolled_back_operations_, rolled_back_writes_);
+    rolled_back_operations_ = 0;
+    rolled_back_writes_ = 0;
+    return counts;
+}
+
+operation_result_t wiredtiger_transaction_t::upsert(key_t key, value_spanc_t value) {
+    write_mark_t mark = mark_writes();
+    auto res = insert(key, value);
+    if (res == 0)
+        conclude_operation(mark);
+    return {size_t(res == 0), to_transaction_status(res)};
+}
+
+operation_result_t wiredtiger_transaction_t::update(key_t key, value_spanc_t value) {
+    WT_CURSOR* cursor = this->cursor(partition_of(key));
+    if (!cursor)
+        return {0, operation_status_t::error_k};
+
+    cursor->set_key(cursor, key);
+    WT_ITEM db_value;
+    db_value.data = value.data();
+    db_value.size = value.size();
+    cursor->set_value(cursor, &db_value);
+    write_mark_t mark = mark_writes();
+    auto res = cursor->update(cursor);
+    cursor->reset(cursor);
+
+    res = conclude_write(res);
+    if (res == 0)
+        conclude_operation(mark);
+    return {size_t(res == 0), to_transaction_status(res)};
+}
+
+operation_result_t wiredtiger_transaction_t::remove(key_t key) {
+    WT_CURSOR* cursor = this->cursor(partition_of(key));
+    if (!cursor)
+        return {0, operation_status_t::error_k};
+
+    cursor->set_key(cursor, key);
+    write_mark_t mark = mark_writes();
+    auto res = cursor->remove(cursor);
+    cursor->reset(cursor);
+
+    res = conclude_write(res == WT_NOTFOUND ? 0 : res);
+    if (res == 0)
+        conclude_operation(mark);
+    return {size_t(res == 0), to_transaction_status(res)};
+}
+
+operation_result_t wiredtiger_transaction_t::read(key_t key, value_span_t value) const {
+    WT_CURSOR* cursor = this->cursor(partition_of(key));
+    if (!cursor)
+        return {0, operation_status_t::error_k};
+
+    cursor->set_key(cursor, key);
+    auto res = cursor->search(cursor);
+    WT_ITEM db_value;
+    if (res == 0)
+        res = cursor->get_value(cursor, &db_value);
+    if (res) {
+        cursor->reset(cursor);
+        return {0, to_transaction_status(conclude(res))};
+    }
+
+    // Note: The value memory is owned by the cursor, so it must be copied before the reset
+    memcpy(value.data(), db_value.data, db_value.size);
+    cursor->reset(cursor);
+
+    return {1, operation_status_t::ok_k};
+}
+
+operation_result_t wiredtiger_transaction_t::read_borrowed(key_t key,
+                                                           value_span_t,
+                                                           value_visitor_t const& visitor) const {
+    WT_CURSOR* cursor = this->cursor(partition_of(key));
+    if (!cursor)
+        return {0, operation_status_t::error_k};
+
+    cursor->set_key(cursor, key);
+    auto res = cursor->search(cursor);
+    WT_ITEM db_value;
+    if (res == 0)
+        res = cursor->get_value(cursor, &db_value);
+    if (res) {
+        cursor->reset(cursor);
+        return {0, to_transaction_status(conclude(res))};
+    }
+
+    visitor(value_spanc_t(reinterpret_cast<std::byte const*>(db_value.data), db_value.size));
+    cursor->reset(cursor);
+
+    return {1, operation_status_t::ok_k};
+}
+
+operation_result_t wiredtiger_transaction_t::batch_upsert(keys_spanc_t keys,
+                                                          values_spanc_t values,
+                                                          value_lengths_spanc_t sizes) {
+
+    write_mark_t mark = mark_writes();
+    size_t offset = 0;
+    for (size_t idx = 0; idx < keys.size(); ++idx) {
+        auto res = insert(keys[idx], values.subspan(offset, sizes[idx]));
+        if (res)
+            return {idx, to_transaction_status(res)};
+        offset += sizes[idx];
+    }
+    conclude_operation(mark);
+    return {keys.size(), operation_status_t::ok_k};
+}
+
+operation_result_t wiredtiger_transaction_t::batch_read(keys_spanc_t keys, values_span_t values) const {
+
+    // Note: imitation of batch read!
+    size_t offset = 0;
+    size_t found_cnt = 0;
+    for (auto key : keys) {
+        WT_CURSOR* cursor = this->cursor(partition_of(key));
+        if (!cursor)
+            return {found_cnt, operation_status_t::error_k};
+
+        WT_ITEM db_value;
+        cursor->set_key(cursor, key);
+        int res = cursor->search(cursor);
+        if (res == 0)
+            res = cursor->get_value(cursor, &db_value);
+        if (res == 0) {
+            memcpy(values.data() + offset, db_value.data, db_value.size);
+            offset += db_value.size;
+            ++found_cnt;
+        }
+        cursor->reset(cursor);
+        if (to_transaction_status(conclude(res)) == operation_status_t::conflict_k)
+            return {found_cnt, operation_status_t::conflict_k};
+    }
+
+    return {found_cnt, operation_status_t::ok_k};
+}
+
+operation_result_t wiredtiger_transaction_t::bulk_load(keys_spanc_t keys,
+                                                       values_spanc_t values,
+                                                       value_lengths_spanc_t sizes) {
+    return batch_upsert(keys, values, sizes);
+}
+
+operation_result_t wiredtiger_transaction_t::range_select(key_t key, size_t length, values_span_t values) const {
+
+    size_t partition = partition_of(key);
+    WT_CURSOR* cursor = this->cursor(partition);
+    if (!cursor)
+        return {0, operation_status_t::error_k};
+
+    cursor->set_key(cursor, key);
+    auto res = cursor->search(cursor);
+    if (res) {
+        cursor->reset(cursor);
+        auto status = to_transaction_status(conclude(res));
+        return {0, status == operation_status_t::conflict_k ? status : operation_status_t::error_k};
+    }
+
+    size_t i = 0;
+    WT_ITEM db_value;
+    size_t offset = 0;
+    size_t selected_records_count = 0;
+    while ((res = next_entry(cursor, partition)) == 0 && i++ < length) {
+        if (cursor->get_value(cursor, &db_value) == 0) {
+            memcpy(values.data() + offset, db_value.data, db_value.size);
+            offset += db_value.size;
+            ++selected_records_count;
+        }
+    }
+    cursor->reset(cursor);
+
+    if (to_transaction_status(conclude(res)) == operation_status_t::conflict_k)
+        return {selected_records_count, operation_status_t::conflict_k};
+    return {selected_records_count, operation_status_t::ok_k};
+}
+
+operation_result_t wiredtiger_transaction_t::scan(key_t key, size_t length, value_span_t single_value) const {
+
+    size_t partition = partition_of(key);
+    WT_CURSOR* cursor = this->cursor(partition);
+    if (!cursor)
+        return {0, operation_status_t::error_k};
+
+    cursor->set_key(cursor, key);
+    auto res = cursor->search(cursor);
+    if (res) {
+        cursor->reset(cursor);
+        auto status = to_transaction_status(conclude(res));
+        return {0, status == operation_status_t::conflict_k ? status : operation_status_t::error_k};
+    }
+
+    size_t i = 0;
+    WT_ITEM db_value;
+    size_t scanned_records_count = 0;
+    while ((res = next_entry(cursor, partition)) == 0 && i++ < length) {
+        if (cursor->get_value(cursor, &db_value) == 0) {
+            memcpy(single_value.data(), db_value.data, db_value.size);
+            ++scanned_records_count;
+        }
+    }
+    cursor->reset(cursor);
+
+    if (to_transaction_status(conclude(res)) == operation_status_t::conflict_k)
+        return {scanned_records_count, operation_status_t::conflict_k};
+    return {scanned_records_count, operation_status_t::ok_k};
+}
+
+} // namespace ucsb::mongo
\ No newline at end of file